@@ -0,0 +1,76 @@
+// clock_gettime and nanosleep are POSIX, not C11; requested before any system header
+#define _POSIX_C_SOURCE 199309L
+#include <stdlib.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+#include "backend.h"
+
+
+bool backend_snapshot(Backend *backend, Frame *frame) {
+    ScreenMetrics screen = backend->metrics(backend);
+    return backend->capture(backend, 0, 0, screen.width, screen.height, frame);
+}
+
+
+int backend_whole_screen(Backend *backend, GameArea *windows, int max) {
+    if (max < 1) {
+        return 0;
+    }
+    ScreenMetrics screen = backend->metrics(backend);
+    GameArea whole = {0, 0, screen.width, screen.height, 0};
+    windows[0] = whole;
+    return 1;
+}
+
+
+bool backend_focus_screen(Backend *backend, const GameArea *window) {
+    (void)backend;
+    (void)window;
+    return true;
+}
+
+
+uint64_t system_now_ms(void) {
+#ifdef _WIN32
+    return GetTickCount64();
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000u + (uint64_t)now.tv_nsec / 1000000u;
+#endif
+}
+
+
+uint64_t system_now_us(void) {
+#ifdef _WIN32
+    LARGE_INTEGER counter, frequency;
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+    return (uint64_t)(counter.QuadPart / frequency.QuadPart * 1000000u
+                      + counter.QuadPart % frequency.QuadPart * 1000000u / frequency.QuadPart);
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000u + (uint64_t)now.tv_nsec / 1000u;
+#endif
+}
+
+
+void system_sleep_ms(unsigned ms) {
+#ifdef _WIN32
+    Sleep(ms);
+#else
+    struct timespec delay = {ms / 1000, (long)(ms % 1000) * 1000000L};
+    while (nanosleep(&delay, &delay) != 0);
+#endif
+}
+
+
+void backend_destroy(Backend *backend) {
+    if (backend != NULL && backend->destroy != NULL) {
+        backend->destroy(backend);
+    }
+}
@@ -0,0 +1,128 @@
+#ifndef BACKEND_H
+#define BACKEND_H
+
+#include <stdbool.h>
+#include "frame.h"
+
+typedef struct {
+    int width;
+    int height;
+} ScreenMetrics;
+
+/**
+ * @brief Part of the screen a game window occupies, in screen pixels
+ */
+typedef struct {
+    int x;
+    int y;
+    int width;
+    int height;
+    uintptr_t id;  // Identity of the window (the HWND on Windows), 0 if the backend can't tell windows apart
+} GameArea;
+
+typedef enum {
+    INPUT_EVENT_MOVE,     // Pointer to absolute coordinates (x, y)
+    INPUT_EVENT_PRESS,    // Left button down
+    INPUT_EVENT_RELEASE,  // Left button up
+    INPUT_EVENT_KEY_DOWN, // Key x (a Windows virtual-key code) down
+    INPUT_EVENT_KEY_UP    // Key x up
+} InputEventType;
+
+/**
+ * @brief One input event. Coordinates are absolute: 0-65535 across the screen,
+ * the format MOUSEEVENTF_ABSOLUTE expects.
+ */
+typedef struct {
+    InputEventType type;
+    int x;
+    int y;
+    unsigned hold_ms;  // Pause after the event before the next one is delivered
+} InputEvent;
+
+/**
+ * @brief Screen and input access behind a small table of function pointers, so the same
+ * bot logic can run against the real desktop, a file-backed framebuffer or the simulator.
+ */
+typedef struct Backend Backend;
+struct Backend {
+    const char *name;
+    void *ctx;
+
+    /**
+     * @brief Copies the screen rectangle (x, y, width, height) into frame, reusing its buffer
+     * @return true on success, false if the screen could not be read
+     */
+    bool (*capture)(Backend *self, int x, int y, int width, int height, Frame *frame);
+
+    /**
+     * @brief Delivers a sequence of input events in order, pausing hold_ms after each.
+     * Events without a pause in between are submitted together as one batch.
+     */
+    void (*send)(Backend *self, const InputEvent *events, int count);
+
+    /**
+     * @brief Returns the current screen resolution
+     */
+    ScreenMetrics (*metrics)(Backend *self);
+
+    /**
+     * @brief Lists the game windows on the screen (client areas), at most max
+     * @return number of windows written
+     */
+    int (*windows)(Backend *self, GameArea *windows, int max);
+
+    /**
+     * @brief Gives the window the keyboard focus, so the keys sent next go to it
+     * @return false if the window could not be brought to the front
+     */
+    bool (*focus)(Backend *self, const GameArea *window);
+
+    /**
+     * @brief Milliseconds since an arbitrary fixed point (monotonic)
+     */
+    uint64_t (*now_ms)(Backend *self);
+
+    void (*sleep_ms)(Backend *self, unsigned ms);
+
+    void (*destroy)(Backend *self);
+};
+
+#ifdef _WIN32
+/**
+ * @brief The real desktop: capture through GDI (BitBlt into a reusable bitmap), input through SendInput
+ */
+Backend *backend_win32_create(void);
+#endif
+
+/**
+ * @brief Capture from a raw 32-bit BGRA framebuffer file (e.g. /dev/fb0 or a dump of it).
+ * The file is re-read on every capture, so rewriting it changes the "screen". Input is ignored.
+ */
+Backend *backend_file_create(const char *path, int width, int height);
+
+/**
+ * @brief Grabs the whole screen into frame as one consistent snapshot.
+ * Any number of probes can then be answered from it with frame_probe().
+ */
+bool backend_snapshot(Backend *backend, Frame *frame);
+
+/**
+ * @brief The whole screen as the only window, for backends that can't tell windows apart
+ */
+int backend_whole_screen(Backend *backend, GameArea *windows, int max);
+
+/**
+ * @brief Focus of a backend with a single window: it always has the focus
+ */
+bool backend_focus_screen(Backend *backend, const GameArea *window);
+
+/**
+ * @brief Monotonic wall clock and sleep of the host, shared by the real-time backends
+ */
+uint64_t system_now_ms(void);
+uint64_t system_now_us(void);  // Same clock in microseconds, for measuring short intervals
+void system_sleep_ms(unsigned ms);
+
+void backend_destroy(Backend *backend);
+
+#endif
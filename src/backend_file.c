@@ -0,0 +1,113 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "backend.h"
+
+typedef struct {
+    char *path;
+    int width;
+    int height;
+} FileContext;
+
+
+static bool file_capture(Backend *self, int x, int y, int width, int height, Frame *frame) {
+    FileContext *ctx = self->ctx;
+
+    // Clipping the requested rectangle to the framebuffer
+    if (x < 0) { width += x; x = 0; }
+    if (y < 0) { height += y; y = 0; }
+    if (x + width > ctx->width) width = ctx->width - x;
+    if (y + height > ctx->height) height = ctx->height - y;
+    if (!frame_reserve(frame, width, height)) {
+        return false;
+    }
+
+    FILE *file = fopen(ctx->path, "rb");
+    if (file == NULL) {
+        printf("Error: Failed to open framebuffer file %s.\n", ctx->path);
+        return false;
+    }
+
+    bool ok = true;
+    for (int row = 0; row < height && ok; row++) {
+        long offset = ((long)(y + row) * ctx->width + x) * (long)sizeof(uint32_t);
+        ok = fseek(file, offset, SEEK_SET) == 0 &&
+             fread(frame->pixels + (size_t)row * frame->stride, sizeof(uint32_t), (size_t)width, file) == (size_t)width;
+    }
+    fclose(file);
+
+    if (!ok) {
+        printf("Error: framebuffer file %s is shorter than %dx%d.\n", ctx->path, ctx->width, ctx->height);
+        return false;
+    }
+
+    frame->x = x;
+    frame->y = y;
+    frame->sequence++;
+    frame->time_ms = system_now_ms();
+    return true;
+}
+
+
+static void file_send(Backend *self, const InputEvent *events, int count) {
+    (void)self;
+    (void)events;
+    (void)count;
+}
+
+
+static ScreenMetrics file_metrics(Backend *self) {
+    FileContext *ctx = self->ctx;
+    ScreenMetrics metrics = {ctx->width, ctx->height};
+    return metrics;
+}
+
+
+static uint64_t file_now_ms(Backend *self) {
+    (void)self;
+    return system_now_ms();
+}
+
+
+static void file_sleep_ms(Backend *self, unsigned ms) {
+    (void)self;
+    system_sleep_ms(ms);
+}
+
+
+static void file_destroy(Backend *self) {
+    FileContext *ctx = self->ctx;
+    free(ctx->path);
+    free(ctx);
+    free(self);
+}
+
+
+Backend *backend_file_create(const char *path, int width, int height) {
+    Backend *backend = calloc(1, sizeof(Backend));
+    FileContext *ctx = calloc(1, sizeof(FileContext));
+    char *path_copy = malloc(strlen(path) + 1);
+    if (backend == NULL || ctx == NULL || path_copy == NULL) {
+        free(backend);
+        free(ctx);
+        free(path_copy);
+        return NULL;
+    }
+
+    strcpy(path_copy, path);
+    ctx->path = path_copy;
+    ctx->width = width;
+    ctx->height = height;
+
+    backend->name = "file";
+    backend->ctx = ctx;
+    backend->capture = file_capture;
+    backend->send = file_send;
+    backend->metrics = file_metrics;
+    backend->windows = backend_whole_screen;
+    backend->focus = backend_focus_screen;
+    backend->now_ms = file_now_ms;
+    backend->sleep_ms = file_sleep_ms;
+    backend->destroy = file_destroy;
+    return backend;
+}
@@ -0,0 +1,238 @@
+#ifdef _WIN32
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <windows.h>
+#include "backend.h"
+
+// Windows titled exactly this are game clients. A substring would also take Explorer folders,
+// browser tabs and the bot's own console, whose titles often contain the game's name.
+#define WIN32_GAME_TITLE "Miscrits"
+
+typedef struct {
+    HDC screen_dc;
+    HDC memory_dc;
+    HBITMAP bitmap;     // Reused while the requested size stays the same
+    HGDIOBJ old_bitmap;
+    int bitmap_width;
+    int bitmap_height;
+} Win32Context;
+
+
+/**
+ * @brief (Re)creates the offscreen bitmap only if the capture size changed
+ */
+static bool win32_prepare_bitmap(Win32Context *ctx, int width, int height) {
+    if (ctx->bitmap != NULL && ctx->bitmap_width == width && ctx->bitmap_height == height) {
+        return true;
+    }
+
+    if (ctx->bitmap != NULL) {
+        SelectObject(ctx->memory_dc, ctx->old_bitmap);
+        DeleteObject(ctx->bitmap);
+        ctx->bitmap = NULL;
+    }
+
+    ctx->bitmap = CreateCompatibleBitmap(ctx->screen_dc, width, height);
+    if (ctx->bitmap == NULL) {
+        printf("Error: Failed to create capture bitmap %dx%d.\n", width, height);
+        return false;
+    }
+    ctx->old_bitmap = SelectObject(ctx->memory_dc, ctx->bitmap);
+    ctx->bitmap_width = width;
+    ctx->bitmap_height = height;
+    return true;
+}
+
+
+static bool win32_capture(Backend *self, int x, int y, int width, int height, Frame *frame) {
+    Win32Context *ctx = self->ctx;
+
+    if (!frame_reserve(frame, width, height) || !win32_prepare_bitmap(ctx, width, height)) {
+        return false;
+    }
+
+    // One blit copies the whole region, so every probe sees the same frame
+    if (!BitBlt(ctx->memory_dc, 0, 0, width, height, ctx->screen_dc, x, y, SRCCOPY | CAPTUREBLT)) {
+        printf("Error: Failed to copy screen region (%d, %d, %d, %d).\n", x, y, width, height);
+        return false;
+    }
+
+    // Negative height requests a top-down DIB, matching the Frame row order
+    BITMAPINFO info = {0};
+    info.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    info.bmiHeader.biWidth = width;
+    info.bmiHeader.biHeight = -height;
+    info.bmiHeader.biPlanes = 1;
+    info.bmiHeader.biBitCount = 32;
+    info.bmiHeader.biCompression = BI_RGB;
+    if (GetDIBits(ctx->memory_dc, ctx->bitmap, 0, (UINT)height, frame->pixels, &info, DIB_RGB_COLORS) != height) {
+        printf("Error: Failed to read captured pixels.\n");
+        return false;
+    }
+
+    frame->x = x;
+    frame->y = y;
+    frame->sequence++;
+    frame->time_ms = system_now_ms();
+    return true;
+}
+
+
+static void win32_send(Backend *self, const InputEvent *events, int count) {
+    (void)self;
+    INPUT batch[32];
+    int batched = 0;
+
+    for (int i = 0; i < count; i++) {
+        INPUT input = {0};
+        input.type = INPUT_MOUSE;
+        if (events[i].type == INPUT_EVENT_KEY_DOWN || events[i].type == INPUT_EVENT_KEY_UP) {
+            // The key goes to the window that has the focus
+            input.type = INPUT_KEYBOARD;
+            input.ki.wVk = (WORD)events[i].x;
+            input.ki.dwFlags = events[i].type == INPUT_EVENT_KEY_UP ? KEYEVENTF_KEYUP : 0;
+        }
+        else if (events[i].type == INPUT_EVENT_MOVE) {
+            // (x, y) are already absolute coordinates (0-65535)
+            input.mi.dx = events[i].x;
+            input.mi.dy = events[i].y;
+            input.mi.dwFlags = MOUSEEVENTF_MOVE | MOUSEEVENTF_ABSOLUTE;
+        }
+        else {
+            input.mi.dwFlags = events[i].type == INPUT_EVENT_PRESS ? MOUSEEVENTF_LEFTDOWN : MOUSEEVENTF_LEFTUP;
+        }
+        batch[batched++] = input;
+
+        // One SendInput call per run of events that need no pause in between
+        bool last = i == count - 1;
+        if (events[i].hold_ms > 0 || last || batched == (int)(sizeof(batch) / sizeof(batch[0]))) {
+            SendInput((UINT)batched, batch, sizeof(INPUT));
+            batched = 0;
+            if (events[i].hold_ms > 0) {
+                Sleep(events[i].hold_ms);
+            }
+        }
+    }
+}
+
+
+static ScreenMetrics win32_metrics(Backend *self) {
+    (void)self;
+    ScreenMetrics metrics = {GetSystemMetrics(SM_CXSCREEN), GetSystemMetrics(SM_CYSCREEN)};
+    return metrics;
+}
+
+
+typedef struct {
+    GameArea *windows;
+    int max;
+    int count;
+} Win32WindowList;
+
+
+static BOOL CALLBACK win32_collect_window(HWND window, LPARAM param) {
+    Win32WindowList *list = (Win32WindowList *)param;
+    char title[256];
+    DWORD process = 0;
+    if (list->count >= list->max || !IsWindowVisible(window) || IsIconic(window) ||
+        GetWindowTextA(window, title, (int)sizeof(title)) <= 0 || strcmp(title, WIN32_GAME_TITLE) != 0) {
+        return TRUE;
+    }
+    // Never one of the bot's own windows, such as the console it runs in
+    GetWindowThreadProcessId(window, &process);
+    if (window == GetConsoleWindow() || process == GetCurrentProcessId()) {
+        return TRUE;
+    }
+
+    // Client area in screen coordinates, without the frame and the title bar
+    RECT client;
+    POINT origin = {0, 0};
+    if (!GetClientRect(window, &client) || !ClientToScreen(window, &origin) || client.right <= 0 || client.bottom <= 0) {
+        return TRUE;
+    }
+    GameArea area = {(int)origin.x, (int)origin.y, (int)client.right, (int)client.bottom, (uintptr_t)window};
+    list->windows[list->count++] = area;
+    return TRUE;
+}
+
+
+static int win32_windows(Backend *self, GameArea *windows, int max) {
+    Win32WindowList list = {windows, max, 0};
+    EnumWindows(win32_collect_window, (LPARAM)&list);
+    // No titled client found (e.g. a fullscreen or browser game): the whole screen
+    return list.count > 0 ? list.count : backend_whole_screen(self, windows, max);
+}
+
+
+static bool win32_focus(Backend *self, const GameArea *window) {
+    HWND handle = (HWND)window->id;
+    if (handle == NULL) {
+        return backend_focus_screen(self, window);
+    }
+    // Allowed while this process sent the last input, which the bot's clicks are
+    if (GetForegroundWindow() != handle) {
+        SetForegroundWindow(handle);
+    }
+    return GetForegroundWindow() == handle;
+}
+
+
+static uint64_t win32_now_ms(Backend *self) {
+    (void)self;
+    return system_now_ms();
+}
+
+
+static void win32_sleep_ms(Backend *self, unsigned ms) {
+    (void)self;
+    system_sleep_ms(ms);
+}
+
+
+static void win32_destroy(Backend *self) {
+    Win32Context *ctx = self->ctx;
+    if (ctx->bitmap != NULL) {
+        SelectObject(ctx->memory_dc, ctx->old_bitmap);
+        DeleteObject(ctx->bitmap);
+    }
+    // Very important: free the DCs we took, otherwise there will be a resource leak.
+    if (ctx->memory_dc != NULL) DeleteDC(ctx->memory_dc);
+    if (ctx->screen_dc != NULL) ReleaseDC(NULL, ctx->screen_dc);
+    free(ctx);
+    free(self);
+}
+
+
+Backend *backend_win32_create(void) {
+    Backend *backend = calloc(1, sizeof(Backend));
+    Win32Context *ctx = calloc(1, sizeof(Win32Context));
+    if (backend == NULL || ctx == NULL) {
+        free(backend);
+        free(ctx);
+        return NULL;
+    }
+
+    backend->name = "win32";
+    backend->ctx = ctx;
+    backend->capture = win32_capture;
+    backend->send = win32_send;
+    backend->metrics = win32_metrics;
+    backend->windows = win32_windows;
+    backend->focus = win32_focus;
+    backend->now_ms = win32_now_ms;
+    backend->sleep_ms = win32_sleep_ms;
+    backend->destroy = win32_destroy;
+
+    ctx->screen_dc = GetDC(NULL);
+    ctx->memory_dc = ctx->screen_dc != NULL ? CreateCompatibleDC(ctx->screen_dc) : NULL;
+    if (ctx->memory_dc == NULL) {
+        printf("Error: Failed to get DC screen.\n");
+        win32_destroy(backend);
+        return NULL;
+    }
+    return backend;
+}
+
+#endif
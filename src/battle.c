@@ -0,0 +1,74 @@
+#include "battle.h"
+
+
+int battle_read_hp(const Frame *frame, const CoordTable *coords, const HpBar *bar) {
+    if (!bar->defined) {
+        return -1;
+    }
+    // The bar in screen pixels, within the frame
+    int left = coords->area.x + (int)(bar->x * coords->scale_x + 0.5);
+    int width = (int)(bar->width * coords->scale_x + 0.5);
+    int y = coords->area.y + (int)((bar->y + bar->height / 2) * coords->scale_y + 0.5);
+    if (width < 1 || y < frame->y || y >= frame->y + frame->height || left < frame->x || left + width > frame->x + frame->width) {
+        return 0;
+    }
+    const uint32_t *row = frame->pixels + (size_t)(y - frame->y) * frame->stride + (left - frame->x);
+    int max_gap = width * BATTLE_HP_GAP_PERCENT / 100;
+    // The bar is empty to the right of the fill: its last pixel tells text from the empty part
+    RGBColor empty = pixel_to_rgb(row[width - 1]);
+
+    // Runs of fill and of anything else; a fill run counts if the gap before it is short enough.
+    // Fill that ends under the text cannot be seen, so half of the text is counted then.
+    int filled = 0, x = 0;
+    while (x < width) {
+        bool fill = are_colors_similar(pixel_to_rgb(row[x]), bar->color, bar->tolerance);
+        int start = x;
+        while (x < width && are_colors_similar(pixel_to_rgb(row[x]), bar->color, bar->tolerance) == fill) {
+            x++;
+        }
+        if (fill) {
+            filled = x;
+            continue;
+        }
+        if (x - start > max_gap || start == 0) {
+            int text = start;
+            while (text < x && text - start <= max_gap && !are_colors_similar(pixel_to_rgb(row[text]), empty, bar->tolerance)) {
+                text++;
+            }
+            if (start > 0 && text > start && text - start <= max_gap) {
+                filled = start + (text - start) / 2;
+            }
+            break;
+        }
+    }
+    return (filled * 100 + width / 2) / width;
+}
+
+
+bool battle_player_turn(const GameConfig *config, const CoordTable *coords, const Frame *frame) {
+    if (!config->has_turn) {
+        return true;
+    }
+    Point point = coord_screen(coords, config->turn.coord);
+    return are_colors_similar(frame_probe(frame, point.x, point.y), config->turn.color, config->turn.tolerance);
+}
+
+
+BattleView battle_read(const GameConfig *config, const CoordTable *coords, const Frame *frame) {
+    BattleView view = {battle_read_hp(frame, coords, &config->hp_bars[HP_ENEMY]),
+                       battle_read_hp(frame, coords, &config->hp_bars[HP_PLAYER]),
+                       battle_player_turn(config, coords, frame)};
+    return view;
+}
+
+
+int battle_choose(const GameMode *mode, const BattleView *view) {
+    for (int i = 0; i < mode->ability_count; i++) {
+        const AbilityRule *rule = &mode->abilities[i];
+        if ((view->enemy_hp < 0 || view->enemy_hp <= rule->enemy_hp_max) &&
+            (view->player_hp < 0 || view->player_hp >= rule->player_hp_min)) {
+            return i;
+        }
+    }
+    return -1;
+}
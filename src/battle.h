@@ -0,0 +1,42 @@
+#ifndef BATTLE_H
+#define BATTLE_H
+
+#include <stdbool.h>
+#include "config.h"
+#include "coords.h"
+#include "frame.h"
+
+// Part of a health bar's width (percent) that may interrupt its fill, e.g. the HP numbers printed over it
+#define BATTLE_HP_GAP_PERCENT 8
+
+/**
+ * @brief What the battle screen shows
+ */
+typedef struct {
+    int enemy_hp;      // Percent, -1 if the bar is not configured
+    int player_hp;
+    bool player_turn;  // Always true without a turn pixel in the data file
+} BattleView;
+
+/**
+ * @brief Reads a health bar by run-length scanning its middle row: the fill is the run of
+ * the bar color from the left edge, through gaps of at most BATTLE_HP_GAP_PERCENT. Fill that
+ * ends under such a gap reads as ending halfway through it.
+ * @return Percent of the bar that is filled, -1 if the bar is not defined
+ */
+int battle_read_hp(const Frame *frame, const CoordTable *coords, const HpBar *bar);
+
+/**
+ * @brief Whether the turn pixel shows it is the player's turn (true if there is none)
+ */
+bool battle_player_turn(const GameConfig *config, const CoordTable *coords, const Frame *frame);
+
+BattleView battle_read(const GameConfig *config, const CoordTable *coords, const Frame *frame);
+
+/**
+ * @brief The first ability rule of the mode that fits the HP. An unknown HP fits every rule.
+ * @return index into mode->abilities, -1 if none fits
+ */
+int battle_choose(const GameMode *mode, const BattleView *view);
+
+#endif
@@ -0,0 +1,257 @@
+#include <stdio.h>
+#include <string.h>
+#include "bot.h"
+
+
+void bot_init(Bot *bot, const GameConfig *config, const GameMode *mode, const CoordTable *coords, unsigned settle_ms) {
+    Bot empty = {0};
+    *bot = empty;
+    bot->config = config;
+    bot->mode = mode;
+    bot->coords = coords;
+    bot->settle_ms = settle_ms;
+    bot->world_state = config_find_state(config, "world");
+    bot->state = STATE_UNKNOWN;
+    bot->acted_state = STATE_UNKNOWN;
+    rotation_init(&bot->rotation, mode);
+}
+
+
+/**
+ * @brief Clicks the next step of the running routine and waits for the screen to settle
+ */
+static BotDecision bot_routine_step(Bot *bot, const Frame *frame, uint64_t now_ms) {
+    const RoutineStep *step = &bot->routine->steps[bot->routine_step++];
+    if (bot->routine_step >= bot->routine->step_count) {
+        bot->routine = NULL;
+        bot->routine_finishing = true;
+    }
+
+    bot->waiting = true;
+    bot->wait_settle = true;
+    bot->wait_turn = TURN_WAIT_NONE;
+    bot->acted_state = bot->state;
+    // The frame before the click is the reference, so an instant change still counts
+    settle_start(&bot->settle);
+    settle_update(&bot->settle, frame_fingerprint(frame), now_ms, bot->settle_ms);
+    waiter_start(&bot->waiter, now_ms, step->timeout_ms);
+    bot->actions++;
+
+    BotDecision decision = {true, step->target, waiter_next_delay(&bot->waiter, now_ms)};
+    return decision;
+}
+
+
+/**
+ * @brief Makes the routine the running one
+ * @param index Routine of the config it was made from, for the telemetry
+ */
+static void bot_start_routine(Bot *bot, const Routine *routine, int index) {
+    bot->routine = routine->step_count > 0 ? routine : NULL;
+    bot->routine_step = 0;
+    bot->routine_index = index;
+    bot->routine_timeouts = 0;
+    bot->routine_finishing = false;
+}
+
+
+BotDecision bot_step(Bot *bot, const Frame *frame, uint64_t now_ms) {
+    BotDecision idle = {false, 0, WAIT_MAX_POLL_MS};
+    const GameConfig *config = bot->config;
+
+    Recognition recognition = recognize(config, bot->coords, frame);
+    if (recognition.matched != bot->matched) {
+        bot->matched = recognition.matched;
+        telemetry_record(bot->telemetry, TELEMETRY_PROBE, bot->instance, recognition.state, 0, recognition.matched, now_ms);
+    }
+    if (recognition.state != bot->state) {
+        telemetry_record(bot->telemetry, TELEMETRY_PHASE, bot->instance, recognition.state, bot->state,
+                         (uint32_t)(now_ms - bot->state_since), now_ms);
+        bot->state = recognition.state;
+        bot->state_since = now_ms;
+        rotation_update(&bot->rotation, bot->state, now_ms);
+        // Back in the world, the next visit of the training window starts a new pass
+        if (bot->state == bot->world_state) {
+            memset(bot->trained, 0, sizeof(bot->trained));
+        }
+    }
+
+    // Still waiting for the result of the last action?
+    if (bot->waiting) {
+        bool done = bot->wait_settle
+            ? settle_update(&bot->settle, frame_fingerprint(frame), now_ms, bot->settle_ms)
+            : bot->state != bot->acted_state && bot->state != STATE_UNKNOWN;
+        // A battle turn is over as soon as the turn pixel changes
+        if (!done && bot->wait_turn != TURN_WAIT_NONE && bot->state == bot->acted_state) {
+            done = battle_player_turn(config, bot->coords, frame) == (bot->wait_turn == TURN_WAIT_PLAYER);
+        }
+        WaitResult result = {done, (unsigned)(now_ms - bot->waiter.started_ms), bot->waiter.polls};
+
+        if (!done) {
+            // While the screen is moving keep the interval short so the settle is noticed early
+            if (bot->wait_settle && bot->settle.changed) {
+                waiter_cap(&bot->waiter, bot->settle_ms / 2 + 1);
+            }
+            unsigned delay = waiter_next_delay(&bot->waiter, now_ms);
+            if (delay > 0) {
+                BotDecision decision = {false, 0, delay};
+                return decision;
+            }
+            // Timeout: the action is repeated below (e.g. the object was still on cooldown)
+            bot->timeouts++;
+            if (bot->wait_settle) {
+                bot->routine_timeouts++;
+            }
+            else {
+                telemetry_record(bot->telemetry, TELEMETRY_RETRY, bot->instance, bot->acted_state, 0, result.elapsed_ms, now_ms);
+            }
+        }
+        else {
+            bot->progress++;
+        }
+        telemetry_record(bot->telemetry, TELEMETRY_WAIT, bot->instance, bot->acted_state, !done, result.elapsed_ms, now_ms);
+
+        char what[2 * CONFIG_NAME_LENGTH + 8];
+        snprintf(what, sizeof(what), "%s -> %s", config_state_name(config, bot->acted_state),
+                 bot->wait_settle ? "settled" :
+                 bot->state != bot->acted_state || bot->wait_turn == TURN_WAIT_NONE ? config_state_name(config, bot->state) :
+                 bot->wait_turn == TURN_WAIT_PLAYER ? "player's turn" : "enemy's turn");
+        wait_report(what, result);
+        bot->waiting = false;
+
+        if (bot->engaging) {
+            bot->engaging = false;
+            telemetry_record(bot->telemetry, TELEMETRY_ENGAGE, bot->instance, bot->acted_state,
+                             bot->rotation.engaged, done, now_ms);
+            rotation_result(&bot->rotation, done, bot->state);
+        }
+
+        if (bot->routine_finishing) {
+            bot->routine_finishing = false;
+            telemetry_record(bot->telemetry, TELEMETRY_ROUTINE, bot->instance, bot->state,
+                             bot->routine_index, (uint32_t)bot->routine_timeouts, now_ms);
+        }
+    }
+
+    if (bot->routine != NULL) {
+        return bot_routine_step(bot, frame, now_ms);
+    }
+
+    if (bot->state == STATE_UNKNOWN) {
+        return idle;
+    }
+
+    // Training and the like start from the world view, once the fight window is closed
+    if (bot->queued != NULL && bot->state == bot->world_state) {
+        bot_start_routine(bot, bot->queued, (int)(bot->queued - config->routines));
+        bot->queued = NULL;
+        if (bot->routine != NULL) {
+            return bot_routine_step(bot, frame, now_ms);
+        }
+    }
+
+    const Action *action = &bot->mode->actions[bot->state];
+    CoordId target = action->target;
+    TurnWait wait_turn = TURN_WAIT_NONE;
+    switch (action->kind) {
+        case ACTION_NONE:
+            return idle;
+        case ACTION_RUN:
+            bot_start_routine(bot, &config->routines[action->routine], action->routine);
+            return bot->routine != NULL ? bot_routine_step(bot, frame, now_ms) : idle;
+        case ACTION_ENGAGE: {
+            uint64_t ready_ms;
+            int next = rotation_next(&bot->rotation, now_ms, &ready_ms);
+            if (next < 0) {
+                return idle;
+            }
+            // Every object is still on cooldown: keep watching the screen until the first is ready
+            if (ready_ms > now_ms) {
+                BotDecision decision = {false, 0, ready_ms - now_ms < WAIT_MAX_POLL_MS ? (unsigned)(ready_ms - now_ms) : WAIT_MAX_POLL_MS};
+                return decision;
+            }
+            rotation_engage(&bot->rotation, next, now_ms);
+            bot->engaging = true;
+            target = bot->rotation.targets[next].target;
+            break;
+        }
+        case ACTION_FIGHT: {
+            BattleView view = battle_read(config, bot->coords, frame);
+            if (!view.player_turn) {
+                // Nothing to click until the enemy has moved
+                bot->waiting = true;
+                bot->wait_settle = false;
+                bot->wait_turn = TURN_WAIT_PLAYER;
+                bot->acted_state = bot->state;
+                waiter_start(&bot->waiter, now_ms, action->timeout_ms);
+                BotDecision decision = {false, 0, waiter_next_delay(&bot->waiter, now_ms)};
+                return decision;
+            }
+            // No rule fits the HP read: the first ability is better than not moving at all
+            int rule = battle_choose(bot->mode, &view);
+            if (rule < 0) {
+                rule = 0;
+            }
+            telemetry_record(bot->telemetry, TELEMETRY_TURN, bot->instance, bot->state, rule,
+                             (uint32_t)(view.enemy_hp < 0 ? 100 : view.enemy_hp), now_ms);
+            target = bot->mode->abilities[rule].target;
+            wait_turn = TURN_WAIT_ENEMY;
+            bot->turns++;
+            break;
+        }
+        case ACTION_TRAIN: {
+            // The first member the window shows ready, every mark read from this frame
+            uint32_t ready = team_ready(config, bot->coords, frame, true);
+            for (int i = 0; i < config->team_size; i++) {
+                if ((ready & (1u << i)) != 0 && bot->trained[i] < TEAM_MAX_TRAININGS) {
+                    const Routine *routine = &config->routines[action->routine];
+                    RoutineStep select = {config->team[i].slot, action->timeout_ms};
+                    bot->training.steps[0] = select;
+                    bot->training.step_count = 1;
+                    for (int k = 0; k < routine->step_count && bot->training.step_count < MAX_ROUTINE_STEPS; k++) {
+                        bot->training.steps[bot->training.step_count++] = routine->steps[k];
+                    }
+                    bot->trained[i]++;
+                    bot_start_routine(bot, &bot->training, action->routine);
+                    return bot_routine_step(bot, frame, now_ms);
+                }
+            }
+            // Nobody left to train: close the window
+            break;
+        }
+        case ACTION_CLICK:
+            break;
+    }
+
+    // A batching mode queues only once enough members show ready on this screen
+    if (action->routine >= 0 && action->kind != ACTION_TRAIN &&
+        (bot->mode->batch == 0 || team_count(team_ready(config, bot->coords, frame, false)) >= bot->mode->batch)) {
+        bot->queued = &config->routines[action->routine];
+    }
+    // A plain click replaces the queued routine: it closes the window that routine would have closed
+    else if (action->routine < 0 && action->kind == ACTION_CLICK) {
+        bot->queued = NULL;
+    }
+    bot->waiting = true;
+    bot->wait_settle = false;
+    bot->wait_turn = wait_turn;
+    bot->acted_state = bot->state;
+    waiter_start(&bot->waiter, now_ms, action->timeout_ms);
+    bot->actions++;
+
+    BotDecision decision = {true, target, waiter_next_delay(&bot->waiter, now_ms)};
+    return decision;
+}
+
+
+void bot_interrupt(Bot *bot, const Routine *routine) {
+    bot->waiting = false;
+    bot->routine = NULL;
+    bot->routine_finishing = false;
+    // A click that was waiting for its result tells nothing about the cooldown
+    bot->engaging = false;
+    bot->rotation.engaged = -1;
+    if (routine != NULL) {
+        bot_start_routine(bot, routine, (int)(routine - bot->config->routines));
+    }
+}
@@ -0,0 +1,96 @@
+#ifndef BOT_H
+#define BOT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "battle.h"
+#include "config.h"
+#include "coords.h"
+#include "frame.h"
+#include "recognizer.h"
+#include "rotation.h"
+#include "team.h"
+#include "telemetry.h"
+#include "wait.h"
+
+/**
+ * @brief What the bot wants done after looking at a frame
+ */
+typedef struct {
+    bool click;          // Click target now
+    CoordId target;
+    unsigned delay_ms;   // Look at the screen again after this long
+} BotDecision;
+
+typedef enum {
+    TURN_WAIT_NONE,     // Not a battle wait
+    TURN_WAIT_ENEMY,    // Ability clicked: wait for the turn to pass (or the battle to end)
+    TURN_WAIT_PLAYER    // Wait for the player's turn (or the battle to end)
+} TurnWait;
+
+/**
+ * @brief State machine of one game client. It never blocks: every call looks at one
+ * captured frame, and the next action comes from the recognized screen.
+ */
+typedef struct {
+    const GameConfig *config;
+    const GameMode *mode;
+    const CoordTable *coords;
+    unsigned settle_ms;
+    int world_state;          // Where queued routines start
+
+    int state;                // Last recognized state
+    uint64_t state_since;
+    uint32_t matched;         // Signatures that matched the last frame
+
+    // Wait after the last action
+    bool waiting;
+    bool wait_settle;         // Routine step: wait for the screen to settle, not for a new state
+    TurnWait wait_turn;       // Battle: wait for the turn to change, or for a new state
+    int acted_state;
+    Waiter waiter;
+    SettleTracker settle;
+
+    // Routine in progress and routine queued for the world view
+    const Routine *routine;
+    int routine_step;
+    int routine_index;        // Index of the running routine in the config
+    int routine_timeouts;     // Steps of the running routine that timed out
+    bool routine_finishing;   // The last step was clicked, its wait is the routine's end
+    const Routine *queued;
+
+    // Training pass: the member's slot click followed by the mode's routine, and the trainings
+    // of every member since the window was opened
+    Routine training;
+    int trained[MAX_TEAM];
+
+    // Spawn objects of the mode, and whether the last action engaged one of them
+    Rotation rotation;
+    bool engaging;
+
+    int actions;
+    int timeouts;
+    int progress;             // Actions whose wait ended with the expected change, for the watchdog
+    int turns;                // Abilities used in battles
+
+    // Events go here, if set (the game window index tells instances apart)
+    Telemetry *telemetry;
+    int instance;
+} Bot;
+
+void bot_init(Bot *bot, const GameConfig *config, const GameMode *mode, const CoordTable *coords, unsigned settle_ms);
+
+/**
+ * @brief Recognizes the screen in frame and decides what to do next
+ * @param now_ms Time the frame was captured
+ */
+BotDecision bot_step(Bot *bot, const Frame *frame, uint64_t now_ms);
+
+/**
+ * @brief Forgets the wait and the routine in progress, after the screen was changed under
+ * the bot (by a recovery step). The next frame is decided afresh.
+ * @param routine Routine to run from the next frame on, NULL for none
+ */
+void bot_interrupt(Bot *bot, const Routine *routine);
+
+#endif
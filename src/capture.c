@@ -0,0 +1,135 @@
+#include <stdio.h>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+#include "capture.h"
+
+// One capture at a time across all capture threads: the backends reuse one bitmap/file handle
+#ifdef _WIN32
+static SRWLOCK capture_lock = SRWLOCK_INIT;
+#else
+static pthread_mutex_t capture_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+
+static bool capture_one(CaptureThread *capture, Frame *frame) {
+    const GameArea *area = &capture->area;
+#ifdef _WIN32
+    AcquireSRWLockExclusive(&capture_lock);
+#else
+    pthread_mutex_lock(&capture_lock);
+#endif
+    bool ok = capture->backend->capture(capture->backend, area->x, area->y, area->width, area->height, frame);
+#ifdef _WIN32
+    ReleaseSRWLockExclusive(&capture_lock);
+#else
+    pthread_mutex_unlock(&capture_lock);
+#endif
+    return ok;
+}
+
+
+#ifdef _WIN32
+static DWORD WINAPI capture_loop(void *arg) {
+#else
+static void *capture_loop(void *arg) {
+#endif
+    CaptureThread *capture = arg;
+    Backend *backend = capture->backend;
+    while (!atomic_load(&capture->stop)) {
+        uint64_t started = backend->now_ms(backend);
+        Frame *frame = &capture->frames[capture->filling];
+        if (capture_one(capture, frame)) {
+            frame->sequence = ++capture->sequence;
+            // Publishing the new frame takes back the previous one; if it was never taken it is lost
+            unsigned previous = atomic_exchange_explicit(&capture->published, capture->filling | CAPTURE_FRESH,
+                                                         memory_order_acq_rel);
+            if (previous & CAPTURE_FRESH) {
+                atomic_fetch_add_explicit(&capture->dropped, 1, memory_order_relaxed);
+            }
+            capture->filling = previous & ~CAPTURE_FRESH;
+            atomic_fetch_add_explicit(&capture->captured, 1, memory_order_relaxed);
+        }
+        else {
+            atomic_fetch_add_explicit(&capture->failed, 1, memory_order_relaxed);
+        }
+
+        uint64_t elapsed = backend->now_ms(backend) - started;
+        if (elapsed < capture->interval_ms) {
+            backend->sleep_ms(backend, (unsigned)(capture->interval_ms - elapsed));
+        }
+    }
+    return 0;
+}
+
+
+bool capture_thread_start(CaptureThread *capture, Backend *backend, GameArea area, unsigned interval_ms) {
+    CaptureThread empty = {0};
+    *capture = empty;
+    capture->backend = backend;
+    capture->area = area;
+    capture->interval_ms = interval_ms;
+    for (int i = 0; i < CAPTURE_BUFFERS; i++) {
+        if (!frame_reserve(&capture->frames[i], area.width, area.height)) {
+            printf("\nError: Failed to allocate the capture frames.\n");
+            capture_thread_stop(capture);
+            return false;
+        }
+    }
+    // Sequence 0 marks the held frame as not captured yet
+    capture->held = 0;
+    capture->filling = 1;
+    atomic_init(&capture->published, 2);
+    atomic_init(&capture->stop, false);
+    atomic_init(&capture->captured, 0);
+    atomic_init(&capture->dropped, 0);
+    atomic_init(&capture->failed, 0);
+
+#ifdef _WIN32
+    capture->thread = CreateThread(NULL, 0, capture_loop, capture, 0, NULL);
+    bool started = capture->thread != NULL;
+#else
+    bool started = pthread_create(&capture->thread, NULL, capture_loop, capture) == 0;
+#endif
+    if (!started) {
+        printf("\nError: Failed to start the capture thread.\n");
+        capture_thread_stop(capture);
+        return false;
+    }
+    capture->running = true;
+    return true;
+}
+
+
+void capture_thread_stop(CaptureThread *capture) {
+    if (capture->running) {
+        capture->running = false;
+        atomic_store(&capture->stop, true);
+#ifdef _WIN32
+        WaitForSingleObject(capture->thread, INFINITE);
+        CloseHandle(capture->thread);
+#else
+        pthread_join(capture->thread, NULL);
+#endif
+    }
+    for (int i = 0; i < CAPTURE_BUFFERS; i++) {
+        frame_free(&capture->frames[i]);
+    }
+}
+
+
+const Frame *capture_thread_latest(CaptureThread *capture, bool *fresh) {
+    bool newer = false;
+    if (atomic_load_explicit(&capture->published, memory_order_acquire) & CAPTURE_FRESH) {
+        // The held frame goes back to the capture thread, which only ever writes the one it fills
+        unsigned taken = atomic_exchange_explicit(&capture->published, capture->held, memory_order_acq_rel);
+        capture->held = taken & ~CAPTURE_FRESH;
+        capture->taken++;
+        newer = true;
+    }
+    if (fresh != NULL) {
+        *fresh = newer;
+    }
+    const Frame *frame = &capture->frames[capture->held];
+    return frame->sequence != 0 ? frame : NULL;
+}
@@ -0,0 +1,69 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+#include "backend.h"
+#include "frame.h"
+
+// Frames of a capture thread: one being filled, one published, one held by the reader
+#define CAPTURE_BUFFERS 3
+
+// Flag of the published index while the reader has not taken that frame yet
+#define CAPTURE_FRESH 0x100u
+
+/**
+ * @brief Captures one screen rectangle on its own thread at a fixed rate into preallocated
+ * frames. The newest frame is handed to the decision thread through one atomic exchange:
+ * the reader never waits for a capture and nothing is copied.
+ * The frames are numbered 1, 2, 3... in Frame.sequence across the buffers.
+ * Only for backends with a real clock (win32, file); captures of all threads are serialized,
+ * since a backend's capture is not reentrant.
+ */
+typedef struct {
+    Backend *backend;
+    GameArea area;
+    unsigned interval_ms;    // Pause between captures, 0 to capture back to back
+    Frame frames[CAPTURE_BUFFERS];
+    atomic_uint published;   // Index of the newest frame, with CAPTURE_FRESH while not taken yet
+    unsigned filling;        // Capture thread only
+    uint64_t sequence;       // Capture thread only: number of the last frame
+    unsigned held;           // Reader only
+    atomic_bool stop;
+    bool running;
+#ifdef _WIN32
+    void *thread;            // HANDLE of the capture thread
+#else
+    pthread_t thread;
+#endif
+
+    // Counters
+    atomic_uint_fast64_t captured;  // Frames published
+    atomic_uint_fast64_t dropped;   // Published frames replaced by a newer one before the reader took them
+    atomic_uint_fast64_t failed;    // Captures the backend could not do
+    uint64_t taken;                 // Reader only: new frames handed out
+} CaptureThread;
+
+/**
+ * @brief Preallocates the frames for the rectangle and starts capturing
+ * @return false if the frames could not be allocated or the thread not started (the error is printed)
+ */
+bool capture_thread_start(CaptureThread *capture, Backend *backend, GameArea area, unsigned interval_ms);
+
+/**
+ * @brief Stops the thread and frees the frames
+ */
+void capture_thread_stop(CaptureThread *capture);
+
+/**
+ * @brief The newest captured frame, without waiting. It stays untouched until the next call.
+ * @param fresh Set to whether the frame is newer than the one returned last time (may be NULL)
+ * @return NULL until the first capture is done
+ */
+const Frame *capture_thread_latest(CaptureThread *capture, bool *fresh);
+
+#endif
@@ -0,0 +1,399 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "config.h"
+
+#define CONFIG_LINE_LENGTH 256
+
+
+static bool config_find_coord(const GameConfig *config, const char *name, CoordId *coord) {
+    for (int i = 0; i < COORD_COUNT; i++) {
+        if (strcmp(COORD_DEFS[i].name, name) == 0) {
+            *coord = (CoordId)i;
+            return true;
+        }
+    }
+    for (int i = 0; i < config->point_count; i++) {
+        if (strcmp(config->point_names[i], name) == 0) {
+            *coord = (CoordId)(COORD_COUNT + i);
+            return true;
+        }
+    }
+    return false;
+}
+
+
+const char *config_coord_name(const GameConfig *config, CoordId coord) {
+    if ((int)coord < COORD_COUNT) {
+        return COORD_DEFS[coord].name;
+    }
+    return (int)coord - COORD_COUNT < config->point_count ? config->point_names[coord - COORD_COUNT] : "unknown";
+}
+
+
+int config_find_routine(const GameConfig *config, const char *name) {
+    for (int i = 0; i < config->routine_count; i++) {
+        if (strcmp(config->routines[i].name, name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+
+int config_find_state(const GameConfig *config, const char *name) {
+    for (int i = 0; i < config->state_count; i++) {
+        if (strcmp(config->states[i].name, name) == 0) {
+            return i;
+        }
+    }
+    return STATE_UNKNOWN;
+}
+
+
+const GameMode *config_find_mode(const GameConfig *config, const char *name) {
+    for (int i = 0; i < config->mode_count; i++) {
+        if (strcmp(config->modes[i].name, name) == 0) {
+            return &config->modes[i];
+        }
+    }
+    return NULL;
+}
+
+
+const char *config_state_name(const GameConfig *config, int state) {
+    return state == STATE_UNKNOWN ? "unknown" : config->states[state].name;
+}
+
+
+/**
+ * @brief Parses one line. Returns an error message, or NULL if the line is fine.
+ */
+static const char *config_parse_line(GameConfig *config, char *line) {
+    char keyword[CONFIG_NAME_LENGTH], name[CONFIG_NAME_LENGTH], extra[CONFIG_NAME_LENGTH], then_routine[CONFIG_NAME_LENGTH];
+    int consumed = 0;
+
+    if (sscanf(line, "%31s%n", keyword, &consumed) != 1 || keyword[0] == '#') {
+        return NULL;
+    }
+    char *args = line + consumed;
+
+    if (strcmp(keyword, "anchor") == 0) {
+        char path[CONFIG_PATH_LENGTH];
+        if (sscanf(args, "%259s %d %d %d %d", path, &config->anchor_width, &config->anchor_height, &config->anchor_x, &config->anchor_y) != 5) {
+            return "expected: anchor <file> <width> <height> <x> <y>";
+        }
+        if (config->anchor_width <= 0 || config->anchor_height <= 0) return "bad anchor size";
+        strcpy(config->anchor_path, path);
+        return NULL;
+    }
+
+    if (strcmp(keyword, "point") == 0) {
+        Point point;
+        CoordId existing;
+        if (config->point_count >= COORD_CUSTOM_MAX) return "too many points";
+        if (sscanf(args, "%31s %d %d", name, &point.x, &point.y) != 3) return "expected: point <name> <x> <y>";
+        if (config_find_coord(config, name, &existing)) return "duplicate coordinate";
+        if (point.x < 0 || point.y < 0 || point.x >= BASE_SCREEN_WIDTH || point.y >= BASE_SCREEN_HEIGHT) return "point outside the base screen";
+        strcpy(config->point_names[config->point_count], name);
+        config->points[config->point_count++] = point;
+        return NULL;
+    }
+
+    if (strcmp(keyword, "hpbar") == 0) {
+        HpBar bar = {true, 0, 0, 0, 0, {0, 0, 0}, 0};
+        if (sscanf(args, "%31s %d %d %d %d %d %d %d %d", name, &bar.x, &bar.y, &bar.width, &bar.height,
+                   &bar.color.r, &bar.color.g, &bar.color.b, &bar.tolerance) != 9) {
+            return "expected: hpbar enemy|player <x> <y> <width> <height> <r> <g> <b> <tolerance>";
+        }
+        if (bar.width <= 0 || bar.height <= 0) return "bad bar size";
+        if (strcmp(name, "enemy") == 0) config->hp_bars[HP_ENEMY] = bar;
+        else if (strcmp(name, "player") == 0) config->hp_bars[HP_PLAYER] = bar;
+        else return "expected: hpbar enemy|player ...";
+        return NULL;
+    }
+
+    if (strcmp(keyword, "turn") == 0) {
+        SignatureProbe probe = {0};
+        if (sscanf(args, "%31s %d %d %d %d", name, &probe.color.r, &probe.color.g, &probe.color.b, &probe.tolerance) != 5) {
+            return "expected: turn <coord> <r> <g> <b> <tolerance>";
+        }
+        if (!config_find_coord(config, name, &probe.coord)) return "unknown coordinate";
+        config->turn = probe;
+        config->has_turn = true;
+        return NULL;
+    }
+
+    if (strcmp(keyword, "team") == 0) {
+        char mark[CONFIG_NAME_LENGTH], line_name[CONFIG_NAME_LENGTH];
+        TeamMember member = {0};
+        SignatureProbe ready = {0};
+        if (config->team_size >= MAX_TEAM) return "too many team members";
+        if (sscanf(args, "%31s %31s %31s %d %d %d %d", name, mark, line_name, &ready.color.r, &ready.color.g, &ready.color.b,
+                   &ready.tolerance) != 7) {
+            return "expected: team <slot> <mark> <line> <r> <g> <b> <tolerance>";
+        }
+        member.mark = ready;
+        member.line = ready;
+        if (!config_find_coord(config, name, &member.slot) || !config_find_coord(config, mark, &member.mark.coord) ||
+            !config_find_coord(config, line_name, &member.line.coord)) {
+            return "unknown coordinate";
+        }
+        config->team[config->team_size++] = member;
+        return NULL;
+    }
+
+    if (strcmp(keyword, "watchdog") == 0) {
+        WatchdogConfig *watchdog = &config->watchdog;
+        if (sscanf(args, "%u %u", &watchdog->stall_ms, &watchdog->unknown_ms) != 2) {
+            return "expected: watchdog <stall_ms> <unknown_ms>";
+        }
+        return NULL;
+    }
+
+    if (strcmp(keyword, "close") == 0) {
+        WatchdogConfig *watchdog = &config->watchdog;
+        if (sscanf(args, "%31s", name) != 1) return "expected: close <coord>";
+        if (watchdog->close_count >= MAX_CLOSE_BUTTONS) return "too many close buttons";
+        if (!config_find_coord(config, name, &watchdog->closes[watchdog->close_count])) return "unknown coordinate";
+        watchdog->close_count++;
+        return NULL;
+    }
+
+    if (strcmp(keyword, "home") == 0) {
+        if (sscanf(args, "%31s", name) != 1) return "expected: home <routine>";
+        config->watchdog.home_routine = config_find_routine(config, name);
+        if (config->watchdog.home_routine < 0) return "unknown routine";
+        return NULL;
+    }
+
+    if (strcmp(keyword, "restart") == 0) {
+        WatchdogConfig *watchdog = &config->watchdog;
+        if (sscanf(args, "%u%n", &watchdog->restart_ms, &consumed) != 1) return "expected: restart <wait_ms> <command>";
+        // The rest of the line is the command, spaces and all
+        char *command = args + consumed;
+        while (*command == ' ' || *command == '\t') command++;
+        if (*command == '\0') return "expected: restart <wait_ms> <command>";
+        if (strlen(command) >= sizeof(watchdog->restart)) return "restart command too long";
+        strcpy(watchdog->restart, command);
+        return NULL;
+    }
+
+    if (strcmp(keyword, "state") == 0) {
+        if (config->state_count >= MAX_STATES) return "too many states";
+        if (sscanf(args, "%31s", name) != 1) return "expected: state <name>";
+        if (config_find_state(config, name) != STATE_UNKNOWN) return "duplicate state";
+        Signature *signature = &config->states[config->state_count++];
+        strcpy(signature->name, name);
+        signature->probe_count = 0;
+        return NULL;
+    }
+
+    if (strcmp(keyword, "probe") == 0) {
+        if (config->state_count == 0) return "probe before any state";
+        Signature *signature = &config->states[config->state_count - 1];
+        SignatureProbe probe = {0};
+        extra[0] = '\0';
+        if (sscanf(args, "%31s %d %d %d %d %31s", name, &probe.color.r, &probe.color.g, &probe.color.b, &probe.tolerance, extra) < 5) {
+            return "expected: probe <coord> <r> <g> <b> <tolerance> [absent]";
+        }
+        if (!config_find_coord(config, name, &probe.coord)) return "unknown coordinate";
+        if (signature->probe_count >= MAX_SIGNATURE_PROBES) return "too many probes";
+        probe.absent = strcmp(extra, "absent") == 0;
+        signature->probes[signature->probe_count++] = probe;
+        return NULL;
+    }
+
+    if (strcmp(keyword, "region") == 0) {
+        if (config->state_count == 0) return "region before any state";
+        Signature *signature = &config->states[config->state_count - 1];
+        SignatureProbe probe = {0};
+        extra[0] = '\0';
+        if (sscanf(args, "%31s %d %d %d %d %d %d %d %31s", name, &probe.width, &probe.height, &probe.color.r, &probe.color.g,
+                   &probe.color.b, &probe.tolerance, &probe.min_percent, extra) < 8) {
+            return "expected: region <coord> <width> <height> <r> <g> <b> <tolerance> <percent> [absent]";
+        }
+        if (!config_find_coord(config, name, &probe.coord)) return "unknown coordinate";
+        if (probe.width <= 0 || probe.height <= 0 || probe.min_percent < 0 || probe.min_percent > 100) return "bad region size or percent";
+        if (signature->probe_count >= MAX_SIGNATURE_PROBES) return "too many probes";
+        probe.absent = strcmp(extra, "absent") == 0;
+        signature->probes[signature->probe_count++] = probe;
+        return NULL;
+    }
+
+    if (strcmp(keyword, "routine") == 0) {
+        if (config->routine_count >= MAX_ROUTINES) return "too many routines";
+        if (sscanf(args, "%31s", name) != 1) return "expected: routine <name>";
+        Routine *routine = &config->routines[config->routine_count++];
+        strcpy(routine->name, name);
+        routine->step_count = 0;
+        return NULL;
+    }
+
+    if (strcmp(keyword, "step") == 0) {
+        if (config->routine_count == 0) return "step before any routine";
+        Routine *routine = &config->routines[config->routine_count - 1];
+        RoutineStep step;
+        if (sscanf(args, "%31s %u", name, &step.timeout_ms) != 2) return "expected: step <coord> <timeout_ms>";
+        if (!config_find_coord(config, name, &step.target)) return "unknown coordinate";
+        if (routine->step_count >= MAX_ROUTINE_STEPS) return "too many steps";
+        routine->steps[routine->step_count++] = step;
+        return NULL;
+    }
+
+    if (strcmp(keyword, "mode") == 0) {
+        if (config->mode_count >= MAX_MODES) return "too many modes";
+        if (sscanf(args, "%31s%n", name, &consumed) != 1) return "expected: mode <name> <title>";
+        GameMode *mode = &config->modes[config->mode_count++];
+        memset(mode, 0, sizeof(*mode));
+        strcpy(mode->name, name);
+        // The rest of the line is the title shown in the menu
+        char *title = args + consumed;
+        while (*title == ' ' || *title == '\t') title++;
+        snprintf(mode->title, sizeof(mode->title), "%s", *title != '\0' ? title : name);
+        for (int i = 0; i < MAX_STATES; i++) {
+            mode->actions[i].kind = ACTION_NONE;
+            mode->actions[i].routine = -1;
+        }
+        return NULL;
+    }
+
+    if (strcmp(keyword, "spawn") == 0) {
+        if (config->mode_count == 0) return "spawn before any mode";
+        GameMode *mode = &config->modes[config->mode_count - 1];
+        Spawn spawn = {0, 0};
+        if (sscanf(args, "%31s %u", name, &spawn.cooldown_ms) < 1) return "expected: spawn <coord> [cooldown_ms]";
+        if (!config_find_coord(config, name, &spawn.target)) return "unknown coordinate";
+        if (mode->spawn_count >= MAX_SPAWNS) return "too many spawns";
+        mode->spawns[mode->spawn_count++] = spawn;
+        return NULL;
+    }
+
+    if (strcmp(keyword, "ability") == 0) {
+        if (config->mode_count == 0) return "ability before any mode";
+        GameMode *mode = &config->modes[config->mode_count - 1];
+        AbilityRule rule = {0, 100, 0};
+        if (sscanf(args, "%31s %d %d", name, &rule.enemy_hp_max, &rule.player_hp_min) < 1) {
+            return "expected: ability <coord> [enemy_hp_max] [player_hp_min]";
+        }
+        if (!config_find_coord(config, name, &rule.target)) return "unknown coordinate";
+        if (mode->ability_count >= MAX_ABILITIES) return "too many abilities";
+        mode->abilities[mode->ability_count++] = rule;
+        return NULL;
+    }
+
+    if (strcmp(keyword, "batch") == 0) {
+        if (config->mode_count == 0) return "batch before any mode";
+        GameMode *mode = &config->modes[config->mode_count - 1];
+        if (sscanf(args, "%d", &mode->batch) != 1 || mode->batch < 0 || mode->batch > MAX_TEAM) {
+            return "expected: batch <ready_members>, at most 4";
+        }
+        if (config->team_size == 0) return "batch without any team member";
+        return NULL;
+    }
+
+    if (strcmp(keyword, "on") == 0) {
+        if (config->mode_count == 0) return "action before any mode";
+        GameMode *mode = &config->modes[config->mode_count - 1];
+        char state_name[CONFIG_NAME_LENGTH], verb[CONFIG_NAME_LENGTH], then[CONFIG_NAME_LENGTH];
+        Action action = {ACTION_NONE, 0, 0, -1};
+        then[0] = '\0';
+
+        int fields = sscanf(args, "%31s %31s %31s %u %31s %31s", state_name, verb, name, &action.timeout_ms, then, then_routine);
+        int state = config_find_state(config, state_name);
+        if (fields < 2) return "expected: on <state> click|engage|fight|train|run|wait ...";
+        if (state == STATE_UNKNOWN) return "unknown state";
+
+        if (strcmp(verb, "click") == 0) {
+            if (fields != 4 && fields != 6) return "expected: on <state> click <coord> <timeout_ms> [then <routine>]";
+            if (!config_find_coord(config, name, &action.target)) return "unknown coordinate";
+            action.kind = ACTION_CLICK;
+            if (fields == 6) {
+                if (strcmp(then, "then") != 0) return "expected: then <routine>";
+                action.routine = config_find_routine(config, then_routine);
+                if (action.routine < 0) return "unknown routine";
+            }
+        }
+        else if (strcmp(verb, "engage") == 0) {
+            // No coordinate: the spawn to click is picked every time
+            fields = sscanf(args, "%31s %31s %u %31s %31s", state_name, verb, &action.timeout_ms, then, then_routine);
+            if (fields != 3 && fields != 5) return "expected: on <state> engage <timeout_ms> [then <routine>]";
+            if (mode->spawn_count == 0) return "engage before any spawn of the mode";
+            action.kind = ACTION_ENGAGE;
+            if (fields == 5) {
+                if (strcmp(then, "then") != 0) return "expected: then <routine>";
+                action.routine = config_find_routine(config, then_routine);
+                if (action.routine < 0) return "unknown routine";
+            }
+        }
+        else if (strcmp(verb, "fight") == 0) {
+            fields = sscanf(args, "%31s %31s %u %31s %31s", state_name, verb, &action.timeout_ms, then, then_routine);
+            if (fields != 3 && fields != 5) return "expected: on <state> fight <timeout_ms> [then <routine>]";
+            if (mode->ability_count == 0) return "fight before any ability of the mode";
+            action.kind = ACTION_FIGHT;
+            if (fields == 5) {
+                if (strcmp(then, "then") != 0) return "expected: then <routine>";
+                action.routine = config_find_routine(config, then_routine);
+                if (action.routine < 0) return "unknown routine";
+            }
+        }
+        else if (strcmp(verb, "train") == 0) {
+            char close[CONFIG_NAME_LENGTH];
+            fields = sscanf(args, "%31s %31s %31s %31s %u", state_name, verb, name, close, &action.timeout_ms);
+            if (fields != 5) return "expected: on <state> train <routine> <close_coord> <timeout_ms>";
+            if (config->team_size == 0) return "train without any team member";
+            action.kind = ACTION_TRAIN;
+            action.routine = config_find_routine(config, name);
+            if (action.routine < 0) return "unknown routine";
+            if (!config_find_coord(config, close, &action.target)) return "unknown coordinate";
+        }
+        else if (strcmp(verb, "run") == 0) {
+            if (fields < 3) return "expected: on <state> run <routine>";
+            action.kind = ACTION_RUN;
+            action.routine = config_find_routine(config, name);
+            if (action.routine < 0) return "unknown routine";
+        }
+        else if (strcmp(verb, "wait") != 0) {
+            return "unknown action";
+        }
+        mode->actions[state] = action;
+        return NULL;
+    }
+
+    return "unknown keyword";
+}
+
+
+bool config_load(GameConfig *config, const char *path) {
+    memset(config, 0, sizeof(*config));
+    config->watchdog.stall_ms = 120000;
+    config->watchdog.unknown_ms = 15000;
+    config->watchdog.home_routine = -1;
+    config->watchdog.restart_ms = 60000;
+
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        printf("Error: Failed to open %s.\n", path);
+        return false;
+    }
+
+    char line[CONFIG_LINE_LENGTH];
+    int number = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), file) != NULL) {
+        number++;
+        line[strcspn(line, "\r\n")] = '\0';
+        const char *error = config_parse_line(config, line);
+        if (error != NULL) {
+            printf("Error: %s:%d: %s.\n", path, number, error);
+            ok = false;
+        }
+    }
+    fclose(file);
+
+    if (ok && (config->state_count == 0 || config->mode_count == 0)) {
+        printf("Error: %s defines no states or no modes.\n", path);
+        ok = false;
+    }
+    return ok;
+}
@@ -0,0 +1,214 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <stdbool.h>
+#include "coords.h"
+#include "frame.h"
+
+#define CONFIG_NAME_LENGTH 32
+#define CONFIG_TITLE_LENGTH 64
+#define CONFIG_PATH_LENGTH 260
+#define MAX_STATES 16
+#define MAX_SIGNATURE_PROBES 8
+#define MAX_ROUTINES 8
+#define MAX_ROUTINE_STEPS 16
+#define MAX_MODES 8
+#define MAX_SPAWNS 8
+#define MAX_ABILITIES 8
+#define MAX_CLOSE_BUTTONS 8
+#define MAX_TEAM 4
+#define CONFIG_COMMAND_LENGTH 200
+
+// No state recognized in the frame
+#define STATE_UNKNOWN (-1)
+
+/**
+ * @brief One pixel, or a region around it, a screen signature expects
+ */
+typedef struct {
+    CoordId coord;
+    RGBColor color;
+    int tolerance;    // Maximum deviation for EACH channel
+    bool absent;      // The color must NOT be there
+    int width;        // Region in base pixels centered on coord, 0 for a single pixel
+    int height;
+    int min_percent;  // Share of the region's pixels that must match
+} SignatureProbe;
+
+/**
+ * @brief A recognizable screen: it is present when all of its probes match
+ */
+typedef struct {
+    char name[CONFIG_NAME_LENGTH];
+    SignatureProbe probes[MAX_SIGNATURE_PROBES];
+    int probe_count;
+} Signature;
+
+typedef struct {
+    CoordId target;
+    unsigned timeout_ms;  // Upper bound of the wait for the screen to settle after the click
+} RoutineStep;
+
+/**
+ * @brief Fixed click sequence through screens that have no signature (e.g. the training dialogs)
+ */
+typedef struct {
+    char name[CONFIG_NAME_LENGTH];
+    RoutineStep steps[MAX_ROUTINE_STEPS];
+    int step_count;
+} Routine;
+
+typedef enum {
+    ACTION_NONE,    // Keep watching the screen
+    ACTION_CLICK,   // Click a target and wait for the state to change
+    ACTION_RUN,     // Run a routine
+    ACTION_ENGAGE,  // Click the spawn object of the mode that is ready soonest and wait for the state to change
+    ACTION_FIGHT,   // On the player's turn click the ability the HP bars call for and wait for the turn to pass
+    ACTION_TRAIN    // Train every team member the window shows ready, then click a target and wait for the state to change
+} ActionKind;
+
+typedef struct {
+    ActionKind kind;
+    CoordId target;
+    unsigned timeout_ms;  // Upper bound of the wait for the next state; the action repeats after it
+    int routine;          // ACTION_RUN: routine to run. ACTION_CLICK/ENGAGE: routine queued for the world view, or -1.
+                          // ACTION_TRAIN: routine that trains a member once its slot is clicked
+} Action;
+
+/**
+ * @brief A world object with a miscrit, which can't be engaged again for a while after a fight
+ */
+typedef struct {
+    CoordId target;
+    unsigned cooldown_ms;  // First guess of the cooldown, the bot learns the real one
+} Spawn;
+
+/**
+ * @brief Ability slot and the HP it is used at. The first rule that fits the battle is taken.
+ */
+typedef struct {
+    CoordId target;
+    int enemy_hp_max;   // Percent: only while the enemy has at most this much
+    int player_hp_min;  // Percent: only while the player has at least this much
+} AbilityRule;
+
+/**
+ * @brief Health bar of the battle screen: its fill runs from the left edge, the rest is empty
+ */
+typedef struct {
+    bool defined;
+    int x;            // Top-left corner and size in base pixels
+    int y;
+    int width;
+    int height;
+    RGBColor color;   // Of the fill
+    int tolerance;
+} HpBar;
+
+typedef enum {
+    HP_ENEMY,
+    HP_PLAYER,
+    HP_BAR_COUNT
+} HpBarId;
+
+/**
+ * @brief A member of the team: its slot in the training window, and the pixels that show it
+ * is ready to train there and on the victory screen
+ */
+typedef struct {
+    CoordId slot;
+    SignatureProbe mark;  // Training window
+    SignatureProbe line;  // Victory screen, its experience line
+} TeamMember;
+
+/**
+ * @brief When a game client counts as stuck and what may get it going again
+ */
+typedef struct {
+    unsigned stall_ms;     // No progress this long on a recognized screen is a stall, 0 to never watch
+    unsigned unknown_ms;   // The same on a screen no signature matches
+    CoordId closes[MAX_CLOSE_BUTTONS];  // Close buttons of popups and menus, clicked in this order
+    int close_count;
+    int home_routine;      // Routine back to the world view from anywhere, -1 for none
+    char restart[CONFIG_COMMAND_LENGTH];  // Command line that restarts the game client, empty for none
+    unsigned restart_ms;   // How long the restarted client takes to show the world view
+} WatchdogConfig;
+
+/**
+ * @brief A farm type: what to do on every recognized screen
+ */
+typedef struct {
+    char name[CONFIG_NAME_LENGTH];
+    char title[CONFIG_TITLE_LENGTH];
+    Action actions[MAX_STATES];  // Indexed by state
+    Spawn spawns[MAX_SPAWNS];    // Objects of the farmed area, for ACTION_ENGAGE
+    int spawn_count;
+    AbilityRule abilities[MAX_ABILITIES];  // In order of preference, for ACTION_FIGHT
+    int ability_count;
+    int batch;                   // Queue a routine only once this many team members are ready, 0 for always
+} GameMode;
+
+/**
+ * @brief Everything loaded from the data file (miscrits.cfg)
+ */
+typedef struct {
+    Signature states[MAX_STATES];  // Signature order is the recognition priority
+    int state_count;
+    Routine routines[MAX_ROUTINES];
+    int routine_count;
+    GameMode modes[MAX_MODES];
+    int mode_count;
+    // Battle screen: the health bars and the pixel that shows it is the player's turn
+    HpBar hp_bars[HP_BAR_COUNT];
+    SignatureProbe turn;
+    bool has_turn;
+    // Named points in base coordinates, CoordId COORD_COUNT + index
+    char point_names[COORD_CUSTOM_MAX][CONFIG_NAME_LENGTH];
+    Point points[COORD_CUSTOM_MAX];
+    int point_count;
+    TeamMember team[MAX_TEAM];
+    int team_size;
+    WatchdogConfig watchdog;
+    // Optional window anchor: raw BGRA template and its top-left corner in base coordinates
+    char anchor_path[CONFIG_PATH_LENGTH];
+    int anchor_width;
+    int anchor_height;
+    int anchor_x;
+    int anchor_y;
+} GameConfig;
+
+/**
+ * @brief Loads signatures, routines and modes from a data file
+ * @return true on success. On error prints the file and line and returns false.
+ */
+bool config_load(GameConfig *config, const char *path);
+
+/**
+ * @brief Finds a state by name
+ * @return state index or STATE_UNKNOWN
+ */
+int config_find_state(const GameConfig *config, const char *name);
+
+/**
+ * @brief Finds a routine by name
+ * @return routine index or -1
+ */
+int config_find_routine(const GameConfig *config, const char *name);
+
+/**
+ * @brief Finds a mode by name
+ * @return NULL if there is no such mode
+ */
+const GameMode *config_find_mode(const GameConfig *config, const char *name);
+
+/**
+ * @brief Returns the name of a built-in coordinate or of a point of the data file
+ */
+const char *config_coord_name(const GameConfig *config, CoordId coord);
+
+/**
+ * @brief Returns the state name for printing ("unknown" for STATE_UNKNOWN)
+ */
+const char *config_state_name(const GameConfig *config, int state);
+
+#endif
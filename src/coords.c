@@ -0,0 +1,76 @@
+#include "coords.h"
+
+const CoordDef COORD_DEFS[COORD_COUNT] = {
+    [COORD_WORLD_OBJECT] = {"world_object", 687, 339},
+    [COORD_ABILITY] = {"ability", 414, 680},
+    [COORD_CLOSE_FIGHT] = {"close_fight", 682, 584},
+    [COORD_START_FIGHT] = {"start_fight", 510, 67},
+    [COORD_GOLDEN_LINE] = {"golden_line", 565, 305},
+    [COORD_TRAIN_OPEN] = {"train_open", 614, 55},
+    [COORD_TRAIN_SLOT] = {"train_slot", 461, 222},
+    [COORD_TRAIN_BUTTON] = {"train_button", 697, 154},
+    [COORD_TRAIN_DIALOG_CLOSE] = {"train_dialog_close", 796, 625},
+    [COORD_TRAIN_PLATINUM] = {"train_platinum", 620, 626},
+    [COORD_TRAIN_PLATINUM_CONFIRM] = {"train_platinum_confirm", 683, 626},
+    [COORD_NEW_ABILITY] = {"new_ability", 791, 342},
+    [COORD_NEW_ABILITY_CLOSE] = {"new_ability_close", 792, 503},
+    [COORD_EVOLUTION] = {"evolution", 479, 164},
+    [COORD_EVOLUTION_CLOSE] = {"evolution_close", 682, 591},
+    [COORD_TRAIN_CLOSE] = {"train_close", 980, 123},
+    [COORD_LEVEL_UP] = {"level_up", 575, 237},
+    [COORD_LEVEL_UP_CLOSE] = {"level_up_close", 684, 516},
+};
+
+
+void coord_table_set_custom(CoordTable *table, const Point *points, int count) {
+    table->custom_count = count < COORD_CUSTOM_MAX ? count : COORD_CUSTOM_MAX;
+    for (int i = 0; i < table->custom_count; i++) {
+        table->custom[i] = points[i];
+    }
+    // No screen matches, so the next refresh rebuilds
+    table->screen.width = 0;
+}
+
+
+void coord_table_build(CoordTable *table, ScreenMetrics screen, GameArea area) {
+    table->screen = screen;
+    table->area = area;
+    table->scale_x = (double)area.width / BASE_SCREEN_WIDTH;
+    table->scale_y = (double)area.height / BASE_SCREEN_HEIGHT;
+
+    for (int i = 0; i < COORD_COUNT + table->custom_count; i++) {
+        Point base;
+        if (i < COORD_COUNT) {
+            base.x = COORD_DEFS[i].base_x;
+            base.y = COORD_DEFS[i].base_y;
+        }
+        else {
+            base = table->custom[i - COORD_COUNT];
+        }
+        // Converting base coordinates into the game area
+        double rel_x = (double)base.x / BASE_SCREEN_WIDTH;
+        double rel_y = (double)base.y / BASE_SCREEN_HEIGHT;
+        Point point = {area.x + (int)(rel_x * area.width), area.y + (int)(rel_y * area.height)};
+
+        // Convert pixel coordinates to absolute coordinates (0-65535)
+        // MOUSEEVENTF_ABSOLUTE requires this normalized format.
+        Point absolute = {(int)((double)point.x / screen.width * ABSOLUTE_RANGE),
+                          (int)((double)point.y / screen.height * ABSOLUTE_RANGE)};
+
+        table->coords[i].screen = point;
+        table->coords[i].absolute = absolute;
+    }
+    table->builds++;
+}
+
+
+bool coord_table_refresh(CoordTable *table, Backend *backend, GameArea area) {
+    ScreenMetrics screen = backend->metrics(backend);
+    if (table->builds > 0 && screen.width == table->screen.width && screen.height == table->screen.height &&
+        area.x == table->area.x && area.y == table->area.y && area.width == table->area.width && area.height == table->area.height) {
+        return false;
+    }
+
+    coord_table_build(table, screen, area);
+    return true;
+}
@@ -0,0 +1,97 @@
+#ifndef COORDS_H
+#define COORDS_H
+
+#include <stdbool.h>
+#include "backend.h"
+#include "frame.h"
+
+// Base screen resolution every coordinate of the game is given in
+#define BASE_SCREEN_WIDTH 1366
+#define BASE_SCREEN_HEIGHT 768
+
+// Full range of MOUSEEVENTF_ABSOLUTE coordinates
+#define ABSOLUTE_RANGE 65535
+
+// Points the data file can name on top of the built-in ones, with CoordIds from COORD_COUNT on
+#define COORD_CUSTOM_MAX 16
+
+/**
+ * @brief Every click target and probe point of the game
+ */
+typedef enum {
+    COORD_WORLD_OBJECT,           // Object with miscrit
+    COORD_ABILITY,                // Miscrit ability in fight
+    COORD_CLOSE_FIGHT,            // Closing fight window
+    COORD_START_FIGHT,            // Probe: fight has started
+    COORD_GOLDEN_LINE,            // Probe: miscrit is ready to train
+    COORD_TRAIN_OPEN,             // Blue button opening the training window
+    COORD_TRAIN_SLOT,             // Miscrit to train
+    COORD_TRAIN_BUTTON,           // Train
+    COORD_TRAIN_DIALOG_CLOSE,     // Closing the training dialog (without platinum)
+    COORD_TRAIN_PLATINUM,         // Training with platinum
+    COORD_TRAIN_PLATINUM_CONFIRM, // Confirming the platinum training
+    COORD_NEW_ABILITY,            // Probe: new ability window
+    COORD_NEW_ABILITY_CLOSE,
+    COORD_EVOLUTION,              // Probe: new evolution window
+    COORD_EVOLUTION_CLOSE,
+    COORD_TRAIN_CLOSE,            // Closing general train window
+    COORD_LEVEL_UP,               // Probe: player has reached a new level
+    COORD_LEVEL_UP_CLOSE,
+    COORD_COUNT
+} CoordId;
+
+typedef struct {
+    const char *name;
+    int base_x;
+    int base_y;
+} CoordDef;
+
+/**
+ * @brief The coordinates in base 1366x768 resolution, indexed by CoordId
+ */
+extern const CoordDef COORD_DEFS[COORD_COUNT];
+
+typedef struct {
+    Point screen;    // Screen pixels, for probes
+    Point absolute;  // 0-65535 input units, for pointer moves
+} ResolvedCoord;
+
+/**
+ * @brief All coordinates pre-scaled for the current geometry, so the loops only do lookups
+ */
+typedef struct {
+    ScreenMetrics screen;
+    GameArea area;
+    double scale_x;  // Screen pixels per base pixel
+    double scale_y;
+    ResolvedCoord coords[COORD_COUNT + COORD_CUSTOM_MAX];
+    Point custom[COORD_CUSTOM_MAX];  // Base coordinates of the data file's points
+    int custom_count;
+    unsigned builds;  // How many times the table was (re)built
+} CoordTable;
+
+/**
+ * @brief Adds the data file's points after the built-in coordinates. The next refresh rebuilds the table.
+ */
+void coord_table_set_custom(CoordTable *table, const Point *points, int count);
+
+/**
+ * @brief Scales every base coordinate into the game area
+ */
+void coord_table_build(CoordTable *table, ScreenMetrics screen, GameArea area);
+
+/**
+ * @brief Rebuilds the table only if the screen resolution or the game area changed since the last build
+ * @return true if the table was rebuilt
+ */
+bool coord_table_refresh(CoordTable *table, Backend *backend, GameArea area);
+
+static inline Point coord_screen(const CoordTable *table, CoordId id) {
+    return table->coords[id].screen;
+}
+
+static inline Point coord_absolute(const CoordTable *table, CoordId id) {
+    return table->coords[id].absolute;
+}
+
+#endif
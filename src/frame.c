@@ -0,0 +1,96 @@
+#include <stdlib.h>
+#include "frame.h"
+
+
+/**
+ * @brief Compares two colors taking into account tolerance (deviation)
+ * @param color1
+ * @param color2
+ * @param tolerance Maximum deviation for EACH channel (R, G, B)
+ * @return true (1) if the colors are similar, false (0) if not.
+ */
+bool are_colors_similar(RGBColor color1, RGBColor color2, int tolerance) {
+    return (abs(color1.r - color2.r) <= tolerance &&
+            abs(color1.g - color2.g) <= tolerance &&
+            abs(color1.b - color2.b) <= tolerance);
+}
+
+
+bool frame_reserve(Frame *frame, int width, int height) {
+    if (width <= 0 || height <= 0) {
+        return false;
+    }
+
+    size_t needed = (size_t)width * (size_t)height;
+    if (needed > frame->capacity) {
+        uint32_t *pixels = realloc(frame->pixels, needed * sizeof(uint32_t));
+        if (pixels == NULL) {
+            return false;
+        }
+        frame->pixels = pixels;
+        frame->capacity = needed;
+    }
+
+    frame->width = width;
+    frame->height = height;
+    frame->stride = width;
+    return true;
+}
+
+
+void frame_free(Frame *frame) {
+    free(frame->pixels);
+    Frame empty = {0};
+    *frame = empty;
+}
+
+
+RGBColor frame_probe(const Frame *frame, int x, int y) {
+    RGBColor color = {-1, -1, -1};
+    int local_x = x - frame->x;
+    int local_y = y - frame->y;
+
+    if (frame->pixels == NULL || local_x < 0 || local_y < 0 || local_x >= frame->width || local_y >= frame->height) {
+        return color;
+    }
+
+    return pixel_to_rgb(frame->pixels[(size_t)local_y * frame->stride + local_x]);
+}
+
+
+void frame_set(Frame *frame, int x, int y, RGBColor color) {
+    frame_fill(frame, x, y, 1, 1, color);
+}
+
+
+void frame_fill(Frame *frame, int x, int y, int width, int height, RGBColor color) {
+    // Clipping the rectangle to the frame
+    int x0 = x - frame->x, y0 = y - frame->y;
+    int x1 = x0 + width, y1 = y0 + height;
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 > frame->width) x1 = frame->width;
+    if (y1 > frame->height) y1 = frame->height;
+
+    uint32_t pixel = rgb_to_pixel(color);
+    for (int row = y0; row < y1; row++) {
+        uint32_t *line = frame->pixels + (size_t)row * frame->stride;
+        for (int col = x0; col < x1; col++) {
+            line[col] = pixel;
+        }
+    }
+}
+
+
+uint64_t frame_fingerprint(const Frame *frame) {
+    // FNV-1a over a sparse grid of pixels
+    const int step = 8;
+    uint64_t hash = 1469598103934665603ull;
+    for (int y = 0; y < frame->height; y += step) {
+        const uint32_t *line = frame->pixels + (size_t)y * frame->stride;
+        for (int x = 0; x < frame->width; x += step) {
+            hash = (hash ^ line[x]) * 1099511628211ull;
+        }
+    }
+    return hash;
+}
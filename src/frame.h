@@ -0,0 +1,82 @@
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    int r;
+    int g;
+    int b;
+} RGBColor;
+
+typedef struct {
+    int x;
+    int y;
+} Point;
+
+/**
+ * @brief One captured screen region in packed 32-bit BGRA (0xAARRGGBB per pixel),
+ * the native layout of a top-down 32bpp DIB. The buffer is allocated once and
+ * reused by every capture, so a frame can be refilled each cycle without allocations.
+ */
+typedef struct {
+    int x;              // Screen coordinate of the top-left pixel
+    int y;
+    int width;
+    int height;
+    int stride;         // Pixels per row
+    uint32_t *pixels;
+    size_t capacity;    // Allocated pixels
+    uint64_t sequence;  // Incremented by every successful capture
+    uint64_t time_ms;   // Backend clock when it was captured
+} Frame;
+
+/**
+ * @brief Compares two colors taking into account tolerance (deviation) for EACH channel (R, G, B)
+ */
+bool are_colors_similar(RGBColor color1, RGBColor color2, int tolerance);
+
+/**
+ * @brief Makes sure the frame can hold width x height pixels. Grows the buffer only when needed.
+ * @return true on success, false if the allocation failed
+ */
+bool frame_reserve(Frame *frame, int width, int height);
+
+/**
+ * @brief Frees the pixel buffer and resets the frame
+ */
+void frame_free(Frame *frame);
+
+/**
+ * @brief Returns the color of the pixel at screen coordinates (x, y) from the captured frame.
+ * @return RGBColor structure. If the point lies outside the frame returns {-1, -1, -1}.
+ */
+RGBColor frame_probe(const Frame *frame, int x, int y);
+
+/**
+ * @brief Writes a color into the frame at screen coordinates (x, y). Points outside are ignored.
+ */
+void frame_set(Frame *frame, int x, int y, RGBColor color);
+
+/**
+ * @brief Fills the rectangle (x, y, width, height) in screen coordinates, clipped to the frame.
+ */
+void frame_fill(Frame *frame, int x, int y, int width, int height, RGBColor color);
+
+/**
+ * @brief Cheap fingerprint of the frame contents, for telling whether the screen changed
+ */
+uint64_t frame_fingerprint(const Frame *frame);
+
+static inline uint32_t rgb_to_pixel(RGBColor color) {
+    return 0xFF000000u | ((uint32_t)(color.r & 0xFF) << 16) | ((uint32_t)(color.g & 0xFF) << 8) | (uint32_t)(color.b & 0xFF);
+}
+
+static inline RGBColor pixel_to_rgb(uint32_t pixel) {
+    RGBColor color = {(int)((pixel >> 16) & 0xFF), (int)((pixel >> 8) & 0xFF), (int)(pixel & 0xFF)};
+    return color;
+}
+
+#endif
@@ -0,0 +1,85 @@
+#include "input.h"
+
+InputHolds input_holds = {20, 40, 0};
+
+
+void input_begin(InputSequence *sequence) {
+    sequence->count = 0;
+}
+
+
+static bool input_push(InputSequence *sequence, InputEventType type, int x, int y, unsigned hold_ms) {
+    if (sequence->count >= INPUT_SEQUENCE_MAX) {
+        return false;
+    }
+    InputEvent event = {type, x, y, hold_ms};
+    sequence->events[sequence->count++] = event;
+    return true;
+}
+
+
+bool input_move(InputSequence *sequence, Point absolute, unsigned hold_ms) {
+    // Already there: only the hold matters. With nothing queued to carry it, a move onto the
+    // same spot does, so a click on the last target still hovers before the press.
+    if (sequence->pointer_known && sequence->pointer.x == absolute.x && sequence->pointer.y == absolute.y) {
+        if (sequence->count == 0) {
+            return input_push(sequence, INPUT_EVENT_MOVE, absolute.x, absolute.y, hold_ms);
+        }
+        if (sequence->events[sequence->count - 1].hold_ms < hold_ms) {
+            sequence->events[sequence->count - 1].hold_ms = hold_ms;
+        }
+        return true;
+    }
+
+    sequence->pointer_known = true;
+    sequence->pointer = absolute;
+
+    // Coalescing with a move that nothing happened after
+    if (sequence->count > 0 && sequence->events[sequence->count - 1].type == INPUT_EVENT_MOVE) {
+        InputEvent *last = &sequence->events[sequence->count - 1];
+        last->x = absolute.x;
+        last->y = absolute.y;
+        last->hold_ms = hold_ms;
+        return true;
+    }
+    return input_push(sequence, INPUT_EVENT_MOVE, absolute.x, absolute.y, hold_ms);
+}
+
+
+bool input_press(InputSequence *sequence, unsigned hold_ms) {
+    return input_push(sequence, INPUT_EVENT_PRESS, 0, 0, hold_ms);
+}
+
+
+bool input_release(InputSequence *sequence, unsigned hold_ms) {
+    return input_push(sequence, INPUT_EVENT_RELEASE, 0, 0, hold_ms);
+}
+
+
+bool input_click(InputSequence *sequence, Point absolute) {
+    if (sequence->count + 3 > INPUT_SEQUENCE_MAX) {
+        return false;
+    }
+    input_move(sequence, absolute, input_holds.move_hold);
+    input_press(sequence, input_holds.press_hold);
+    input_release(sequence, input_holds.release_hold);
+    return true;
+}
+
+
+bool input_key(InputSequence *sequence, int key) {
+    if (sequence->count + 2 > INPUT_SEQUENCE_MAX) {
+        return false;
+    }
+    input_push(sequence, INPUT_EVENT_KEY_DOWN, key, 0, input_holds.press_hold);
+    input_push(sequence, INPUT_EVENT_KEY_UP, key, 0, input_holds.release_hold);
+    return true;
+}
+
+
+void input_submit(Backend *backend, InputSequence *sequence) {
+    if (sequence->count > 0) {
+        backend->send(backend, sequence->events, sequence->count);
+    }
+    sequence->count = 0;
+}
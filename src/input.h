@@ -0,0 +1,66 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <stdbool.h>
+#include "backend.h"
+#include "frame.h"
+
+#define INPUT_SEQUENCE_MAX 64
+
+// Virtual-key codes of the keys the bot presses (the Windows VK_ values)
+#define INPUT_KEY_ESCAPE 0x1B
+
+/**
+ * @brief Pauses a click is built with (ms)
+ */
+typedef struct {
+    unsigned move_hold;     // After moving onto the target, so the game sees the hover
+    unsigned press_hold;    // Between button down and up
+    unsigned release_hold;  // After button up
+} InputHolds;
+
+// Default holds used by input_click(), configurable at startup
+extern InputHolds input_holds;
+
+/**
+ * @brief Queue of input events submitted to the backend in a single call. It remembers
+ * where the pointer was left, so a click on the same target does not move it again.
+ */
+typedef struct {
+    InputEvent events[INPUT_SEQUENCE_MAX];
+    int count;
+    bool pointer_known;
+    Point pointer;  // Absolute position of the pointer after the queued events
+} InputSequence;
+
+/**
+ * @brief Drops the queued events, keeping the known pointer position
+ */
+void input_begin(InputSequence *sequence);
+
+/**
+ * @brief Queues a pointer move. A move to where the pointer already is only adds its hold
+ * to the last queued event, and consecutive moves are merged into the last one.
+ * @return false if the sequence is full
+ */
+bool input_move(InputSequence *sequence, Point absolute, unsigned hold_ms);
+
+bool input_press(InputSequence *sequence, unsigned hold_ms);
+bool input_release(InputSequence *sequence, unsigned hold_ms);
+
+/**
+ * @brief Queues move + press + release on the target with the default holds
+ */
+bool input_click(InputSequence *sequence, Point absolute);
+
+/**
+ * @brief Queues a key press (down + up) with the press and release holds of a click
+ */
+bool input_key(InputSequence *sequence, int key);
+
+/**
+ * @brief Delivers the queued events with one backend call and empties the queue
+ */
+void input_submit(Backend *backend, InputSequence *sequence);
+
+#endif
@@ -0,0 +1,503 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "locator.h"
+#include "wait.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define LOCATOR_SSE2 1
+#endif
+
+// Coarse matches (best position of a scale) refined level by level
+#define LOCATOR_CANDIDATES 6
+
+// Every scale tried by the coarse search is this much smaller than the previous one
+#define LOCATOR_SCALE_STEP 0.96
+
+// Final scale refinement: +-LOCATOR_FINE_STEPS steps of LOCATOR_FINE_SCALE around the best match
+#define LOCATOR_FINE_STEPS 10
+#define LOCATOR_FINE_SCALE 0.0025
+
+// Smallest template side, in pixels, the coarse level may shrink the anchor to
+#define LOCATOR_MIN_TEMPLATE 3
+
+typedef struct {
+    int x;          // Position on the candidate's level
+    int y;
+    int level;
+    double scale;
+    double score;   // Mean absolute difference per pixel, lower is better
+} Candidate;
+
+
+static inline uint8_t pixel_gray(uint32_t pixel) {
+    return (uint8_t)((((pixel >> 16) & 0xFF) * 77 + ((pixel >> 8) & 0xFF) * 150 + (pixel & 0xFF) * 29) >> 8);
+}
+
+
+static bool gray_reserve(GrayImage *image, int width, int height) {
+    if (width <= 0 || height <= 0) {
+        return false;
+    }
+    size_t needed = (size_t)width * (size_t)height;
+    if (needed > image->capacity) {
+        uint8_t *pixels = realloc(image->pixels, needed);
+        if (pixels == NULL) {
+            return false;
+        }
+        image->pixels = pixels;
+        image->capacity = needed;
+    }
+    image->width = width;
+    image->height = height;
+    return true;
+}
+
+
+static void gray_free(GrayImage *image) {
+    free(image->pixels);
+    GrayImage empty = {0};
+    *image = empty;
+}
+
+
+/**
+ * @brief Halves the image: every pixel is the average of a 2x2 block
+ */
+static bool gray_downsample(const GrayImage *source, GrayImage *target) {
+    if (!gray_reserve(target, source->width / 2, source->height / 2)) {
+        return false;
+    }
+    for (int y = 0; y < target->height; y++) {
+        const uint8_t *top = source->pixels + (size_t)(2 * y) * source->width;
+        const uint8_t *bottom = top + source->width;
+        uint8_t *row = target->pixels + (size_t)y * target->width;
+        for (int x = 0; x < target->width; x++) {
+            row[x] = (uint8_t)((top[2 * x] + top[2 * x + 1] + bottom[2 * x] + bottom[2 * x + 1] + 2) >> 2);
+        }
+    }
+    return true;
+}
+
+
+/**
+ * @brief Renders the anchor in gray at a scale (nearest pixel, like the game scales its UI)
+ */
+static bool render_template(const Anchor *anchor, double scale, GrayImage *target) {
+    int width = (int)(anchor->image.width * scale + 0.5), height = (int)(anchor->image.height * scale + 0.5);
+    if (!gray_reserve(target, width, height)) {
+        return false;
+    }
+    for (int y = 0; y < height; y++) {
+        int source_y = (int)((y + 0.5) / scale);
+        if (source_y >= anchor->image.height) source_y = anchor->image.height - 1;
+        const uint32_t *source = anchor->image.pixels + (size_t)source_y * anchor->image.stride;
+        for (int x = 0; x < width; x++) {
+            int source_x = (int)((x + 0.5) / scale);
+            if (source_x >= anchor->image.width) source_x = anchor->image.width - 1;
+            target->pixels[(size_t)y * width + x] = pixel_gray(source[source_x]);
+        }
+    }
+    return true;
+}
+
+
+/**
+ * @brief Coarsest pyramid level on which the template keeps LOCATOR_MIN_TEMPLATE pixels per side
+ */
+static int template_level(const GrayImage *template) {
+    int level = 0;
+    while (level + 1 < LOCATOR_LEVELS && (template->width >> (level + 1)) >= LOCATOR_MIN_TEMPLATE &&
+           (template->height >> (level + 1)) >= LOCATOR_MIN_TEMPLATE) {
+        level++;
+    }
+    return level;
+}
+
+
+/**
+ * @brief Renders the anchor at a scale into templates[0..level]
+ */
+static bool prepare_templates(Locator *locator, double scale, int *level) {
+    if (!render_template(locator->anchor, scale, &locator->templates[0])) {
+        return false;
+    }
+    *level = template_level(&locator->templates[0]);
+    for (int k = 1; k <= *level; k++) {
+        if (!gray_downsample(&locator->templates[k - 1], &locator->templates[k])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/**
+ * @brief Sum of absolute differences of two rows of gray pixels
+ */
+static inline unsigned row_sad(const uint8_t *a, const uint8_t *b, int count) {
+    unsigned sum = 0;
+    int col = 0;
+#ifdef LOCATOR_SSE2
+    // PSADBW: 16 differences summed per instruction, SSE2 is always there on x86-64
+    __m128i total = _mm_setzero_si128();
+    for (; col + 16 <= count; col += 16) {
+        __m128i va = _mm_loadu_si128((const __m128i *)(a + col));
+        __m128i vb = _mm_loadu_si128((const __m128i *)(b + col));
+        total = _mm_add_epi64(total, _mm_sad_epu8(va, vb));
+    }
+    sum = (unsigned)(_mm_cvtsi128_si32(total) + _mm_cvtsi128_si32(_mm_srli_si128(total, 8)));
+#endif
+    for (; col < count; col++) {
+        sum += (unsigned)abs(a[col] - b[col]);
+    }
+    return sum;
+}
+
+
+/**
+ * @brief Sum of absolute differences of the template placed at (x, y). Stops early once
+ * the sum reaches limit, the caller only cares that it is not better.
+ */
+static unsigned template_sad(const GrayImage *image, int x, int y, const GrayImage *template, unsigned limit) {
+    unsigned sum = 0;
+    for (int row = 0; row < template->height; row++) {
+        sum += row_sad(image->pixels + (size_t)(y + row) * image->width + x, template->pixels + (size_t)row * template->width,
+                       template->width);
+        if (sum >= limit) {
+            return sum;
+        }
+    }
+    return sum;
+}
+
+
+/**
+ * @brief Normalized cross-correlation of the template placed at (x, y), from -1 to 1
+ */
+static double template_ncc(const GrayImage *image, int x, int y, const GrayImage *template) {
+    int64_t sum_i = 0, sum_t = 0, sum_ii = 0, sum_tt = 0, sum_it = 0;
+    for (int row = 0; row < template->height; row++) {
+        const uint8_t *a = image->pixels + (size_t)(y + row) * image->width + x;
+        const uint8_t *b = template->pixels + (size_t)row * template->width;
+        for (int col = 0; col < template->width; col++) {
+            sum_i += a[col];
+            sum_t += b[col];
+            sum_ii += a[col] * a[col];
+            sum_tt += b[col] * b[col];
+            sum_it += a[col] * b[col];
+        }
+    }
+    double n = (double)template->width * template->height;
+    double covariance = sum_it - sum_i * (double)sum_t / n;
+    double variance_i = sum_ii - sum_i * (double)sum_i / n;
+    double variance_t = sum_tt - sum_t * (double)sum_t / n;
+    if (variance_i <= 0.0 || variance_t <= 0.0) {
+        return 0.0;
+    }
+    return covariance / sqrt(variance_i * variance_t);
+}
+
+
+/**
+ * @brief Keeps the LOCATOR_CANDIDATES best candidates sorted by score
+ */
+static void insert_candidate(Candidate *candidates, int *count, Candidate candidate) {
+    if (*count == LOCATOR_CANDIDATES && candidates[LOCATOR_CANDIDATES - 1].score <= candidate.score) {
+        return;
+    }
+    int at = *count < LOCATOR_CANDIDATES ? (*count)++ : LOCATOR_CANDIDATES - 1;
+    while (at > 0 && candidates[at - 1].score > candidate.score) {
+        candidates[at] = candidates[at - 1];
+        at--;
+    }
+    candidates[at] = candidate;
+}
+
+
+/**
+ * @brief Best SAD position of the template on one level within +-radius of (x, y)
+ */
+static Point refine_position(const GrayImage *image, const GrayImage *template, int x, int y, int radius) {
+    Point best = {x, y};
+    unsigned best_sad = UINT32_MAX;
+    for (int dy = -radius; dy <= radius; dy++) {
+        for (int dx = -radius; dx <= radius; dx++) {
+            int px = x + dx, py = y + dy;
+            if (px < 0 || py < 0 || px + template->width > image->width || py + template->height > image->height) {
+                continue;
+            }
+            unsigned sad = template_sad(image, px, py, template, best_sad);
+            if (sad < best_sad) {
+                best_sad = sad;
+                best.x = px;
+                best.y = py;
+            }
+        }
+    }
+    return best;
+}
+
+
+/**
+ * @brief Best NCC position at full resolution within +-radius of (x, y)
+ */
+static double best_ncc(const GrayImage *image, const GrayImage *template, int x, int y, int radius, Point *position) {
+    double best = -1.0;
+    for (int dy = -radius; dy <= radius; dy++) {
+        for (int dx = -radius; dx <= radius; dx++) {
+            int px = x + dx, py = y + dy;
+            if (px < 0 || py < 0 || px + template->width > image->width || py + template->height > image->height) {
+                continue;
+            }
+            double score = template_ncc(image, px, py, template);
+            if (score > best) {
+                best = score;
+                position->x = px;
+                position->y = py;
+            }
+        }
+    }
+    return best;
+}
+
+
+/**
+ * @brief The coarse scales are a few percent apart, a wide anchor needs the scale to a fraction
+ * of a percent. Neighbouring scales can render the same pixels, the middle of such a run is the best guess.
+ * @return NCC of the best scale; scale and position are updated to it
+ */
+static double refine_scale(Locator *locator, double *scale, Point *position) {
+    double scores[2 * LOCATOR_FINE_STEPS + 1];
+    Point positions[2 * LOCATOR_FINE_STEPS + 1];
+    double top = -1.0;
+    for (int step = -LOCATOR_FINE_STEPS; step <= LOCATOR_FINE_STEPS; step++) {
+        int i = step + LOCATOR_FINE_STEPS;
+        scores[i] = -1.0;
+        positions[i] = *position;
+        if (render_template(locator->anchor, *scale * (1.0 + step * LOCATOR_FINE_SCALE), &locator->templates[0])) {
+            scores[i] = best_ncc(&locator->pyramid[0], &locator->templates[0], position->x, position->y, 2, &positions[i]);
+        }
+        top = fmax(top, scores[i]);
+    }
+
+    int first = -1, last = -1;
+    for (int i = 0; i <= 2 * LOCATOR_FINE_STEPS; i++) {
+        if (scores[i] >= top - 1e-9) {
+            if (first < 0) first = i;
+            last = i;
+        }
+    }
+    int chosen = (first + last) / 2;
+    *scale *= 1.0 + (chosen - LOCATOR_FINE_STEPS) * LOCATOR_FINE_SCALE;
+    *position = positions[chosen];
+    return top;
+}
+
+
+static bool build_pyramid(Locator *locator, const Frame *frame) {
+    GrayImage *base = &locator->pyramid[0];
+    if (!gray_reserve(base, frame->width, frame->height)) {
+        return false;
+    }
+    for (int y = 0; y < frame->height; y++) {
+        const uint32_t *source = frame->pixels + (size_t)y * frame->stride;
+        uint8_t *row = base->pixels + (size_t)y * base->width;
+        for (int x = 0; x < frame->width; x++) {
+            row[x] = pixel_gray(source[x]);
+        }
+    }
+    for (int k = 1; k < LOCATOR_LEVELS; k++) {
+        if (!gray_downsample(&locator->pyramid[k - 1], &locator->pyramid[k])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+bool anchor_load(Anchor *anchor, const char *path, int width, int height, int base_x, int base_y) {
+    Frame empty = {0};
+    anchor->image = empty;
+    anchor->base_x = base_x;
+    anchor->base_y = base_y;
+    if (!frame_reserve(&anchor->image, width, height)) {
+        printf("Error: Bad anchor size %dx%d.\n", width, height);
+        return false;
+    }
+
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        printf("Error: Failed to open anchor file %s.\n", path);
+        anchor_free(anchor);
+        return false;
+    }
+    size_t count = (size_t)width * (size_t)height;
+    bool ok = fread(anchor->image.pixels, sizeof(uint32_t), count, file) == count;
+    fclose(file);
+    if (!ok) {
+        printf("Error: Anchor file %s is shorter than %dx%d.\n", path, width, height);
+        anchor_free(anchor);
+    }
+    return ok;
+}
+
+
+void anchor_free(Anchor *anchor) {
+    frame_free(&anchor->image);
+}
+
+
+void locator_init(Locator *locator, const Anchor *anchor) {
+    memset(locator, 0, sizeof(*locator));
+    locator->anchor = anchor;
+    locator->scale = 1.0;
+}
+
+
+void locator_reset(Locator *locator) {
+    locator->located = false;
+    locator->next_search_ms = 0;
+}
+
+
+void locator_free(Locator *locator) {
+    for (int k = 0; k < LOCATOR_LEVELS; k++) {
+        gray_free(&locator->pyramid[k]);
+        gray_free(&locator->templates[k]);
+    }
+    gray_free(&locator->verify);
+}
+
+
+bool locator_search(Locator *locator, const Frame *frame) {
+    const Anchor *anchor = locator->anchor;
+    locator->searches++;
+    if (anchor == NULL || !build_pyramid(locator, frame)) {
+        return false;
+    }
+
+    // Coarse: every scale on its coarsest level, the best position of each scale
+    Candidate candidates[LOCATOR_CANDIDATES];
+    int candidate_count = 0;
+    double max_scale = fmin((double)frame->width / BASE_SCREEN_WIDTH, (double)frame->height / BASE_SCREEN_HEIGHT);
+    max_scale = fmin(max_scale, LOCATOR_MAX_SCALE);
+    for (double scale = max_scale; scale >= LOCATOR_MIN_SCALE; scale *= LOCATOR_SCALE_STEP) {
+        int level;
+        if (!prepare_templates(locator, scale, &level)) {
+            continue;
+        }
+        const GrayImage *image = &locator->pyramid[level], *template = &locator->templates[level];
+        unsigned pixels = (unsigned)(template->width * template->height);
+        unsigned limit = UINT32_MAX;
+        if (candidate_count == LOCATOR_CANDIDATES) {
+            limit = (unsigned)(candidates[LOCATOR_CANDIDATES - 1].score * pixels);
+        }
+
+        Candidate best = {0, 0, level, scale, -1.0};
+        for (int y = 0; y + template->height <= image->height; y++) {
+            for (int x = 0; x + template->width <= image->width; x++) {
+                unsigned sad = template_sad(image, x, y, template, limit);
+                if (sad < limit) {
+                    limit = sad;
+                    best.x = x;
+                    best.y = y;
+                    best.score = (double)sad / pixels;
+                }
+            }
+        }
+        if (best.score >= 0.0) {
+            insert_candidate(candidates, &candidate_count, best);
+        }
+    }
+
+    // Fine: every candidate down the pyramid, then its scale settled by NCC on full resolution
+    double best_score = -1.0, scale = 1.0;
+    Point best_position = {0, 0};
+    for (int i = 0; i < candidate_count; i++) {
+        int level;
+        if (!prepare_templates(locator, candidates[i].scale, &level)) {
+            continue;
+        }
+        Point position = {candidates[i].x, candidates[i].y};
+        for (int k = candidates[i].level - 1; k >= 0; k--) {
+            position = refine_position(&locator->pyramid[k], &locator->templates[k], position.x * 2, position.y * 2, 2);
+        }
+        double candidate_scale = candidates[i].scale;
+        double score = refine_scale(locator, &candidate_scale, &position);
+        if (score > best_score) {
+            best_score = score;
+            scale = candidate_scale;
+            best_position = position;
+        }
+    }
+    if (best_score < LOCATOR_MIN_SCORE) {
+        return false;
+    }
+    // The verify-probe compares against the anchor as it was actually found on screen,
+    // so scaling artifacts of the template don't count as a difference
+    GrayImage *verify = &locator->verify;
+    if (!render_template(anchor, scale, verify)) {
+        return false;
+    }
+    for (int row = 0; row < verify->height; row++) {
+        memcpy(verify->pixels + (size_t)row * verify->width,
+               locator->pyramid[0].pixels + (size_t)(best_position.y + row) * locator->pyramid[0].width + best_position.x,
+               (size_t)verify->width);
+    }
+
+    Point position = {frame->x + best_position.x, frame->y + best_position.y};
+    GameArea area = {position.x - (int)(anchor->base_x * scale + 0.5), position.y - (int)(anchor->base_y * scale + 0.5),
+                     (int)(BASE_SCREEN_WIDTH * scale + 0.5), (int)(BASE_SCREEN_HEIGHT * scale + 0.5), 0};
+    if (wait_verbose && (!locator->located || memcmp(&area, &locator->area, sizeof(area)) != 0)) {
+        printf("\nGame window: %dx%d at (%d, %d)", area.width, area.height, area.x, area.y);
+    }
+    locator->located = true;
+    locator->scale = scale;
+    locator->position = position;
+    locator->area = area;
+    return true;
+}
+
+
+bool locator_verify(Locator *locator, const Frame *frame) {
+    const GrayImage *template = &locator->verify;
+    locator->verifies++;
+    int x = locator->position.x - frame->x, y = locator->position.y - frame->y;
+    if (!locator->located || x < 0 || y < 0 || x + template->width > frame->width || y + template->height > frame->height) {
+        return false;
+    }
+
+    // Every other pixel of every other row is plenty to tell the anchor from anything else
+    unsigned sum = 0, count = 0;
+    for (int row = 0; row < template->height; row += 2) {
+        const uint32_t *a = frame->pixels + (size_t)(y + row) * frame->stride + x;
+        const uint8_t *b = template->pixels + (size_t)row * template->width;
+        for (int col = 0; col < template->width; col += 2) {
+            sum += (unsigned)abs(pixel_gray(a[col]) - b[col]);
+            count++;
+        }
+    }
+    return sum <= count * LOCATOR_VERIFY_TOLERANCE;
+}
+
+
+GameArea locator_update(Locator *locator, const Frame *frame, uint64_t now) {
+    GameArea whole = {frame->x, frame->y, frame->width, frame->height, 0};
+    if (locator->anchor == NULL) {
+        return whole;
+    }
+    if (locator->located && locator_verify(locator, frame)) {
+        return locator->area;
+    }
+
+    if (now >= locator->next_search_ms) {
+        if (locator_search(locator, frame)) {
+            return locator->area;
+        }
+        locator->next_search_ms = now + LOCATOR_RETRY_MS;
+    }
+    return locator->located ? locator->area : whole;
+}
@@ -0,0 +1,99 @@
+#ifndef LOCATOR_H
+#define LOCATOR_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "coords.h"
+#include "frame.h"
+
+// Pyramid levels of the full search (level k is the screen downscaled 2^k times)
+#define LOCATOR_LEVELS 4
+
+// Smallest and largest game scale the full search tries (game width / BASE_SCREEN_WIDTH)
+#define LOCATOR_MIN_SCALE 0.3
+#define LOCATOR_MAX_SCALE 2.0
+
+// Lowest normalized cross-correlation accepted as the anchor
+#define LOCATOR_MIN_SCORE 0.8
+
+// Largest mean gray difference the verify-probe tolerates at the cached position
+#define LOCATOR_VERIFY_TOLERANCE 12
+
+// Pause between full searches while the anchor can't be found (ms)
+#define LOCATOR_RETRY_MS 1000
+
+/**
+ * @brief A piece of the game UI that is always on screen, in base 1366x768 pixels
+ */
+typedef struct {
+    Frame image;  // Template pixels (x and y unused)
+    int base_x;   // Top-left corner of the template in the base layout
+    int base_y;
+} Anchor;
+
+/**
+ * @brief 8-bit luminance image, one level of the search pyramid
+ */
+typedef struct {
+    int width;
+    int height;
+    uint8_t *pixels;
+    size_t capacity;
+} GrayImage;
+
+/**
+ * @brief Finds the game inside the screen by the anchor and remembers where it is
+ */
+typedef struct {
+    const Anchor *anchor;  // NULL: the game fills the whole captured window
+    bool located;
+    GameArea area;         // Game client area in screen pixels
+    double scale;          // Screen pixels per base pixel
+    Point position;        // Screen position of the anchor's top-left corner
+    GrayImage pyramid[LOCATOR_LEVELS];
+    GrayImage templates[LOCATOR_LEVELS];  // Anchor scaled for the search, scratch
+    GrayImage verify;      // Anchor as found on screen, for the verify-probe
+    uint64_t next_search_ms;
+    int searches;          // Full searches run
+    int verifies;          // Verify-probes run
+} Locator;
+
+/**
+ * @brief Loads an anchor template from a raw BGRA file (width * height 32-bit pixels)
+ * @return true on success. On error prints the file and returns false.
+ */
+bool anchor_load(Anchor *anchor, const char *path, int width, int height, int base_x, int base_y);
+
+void anchor_free(Anchor *anchor);
+
+void locator_init(Locator *locator, const Anchor *anchor);
+
+/**
+ * @brief Forgets where the game was, so the next update searches the whole frame for it
+ */
+void locator_reset(Locator *locator);
+
+void locator_free(Locator *locator);
+
+/**
+ * @brief Full coarse-to-fine search of the anchor in a whole-screen frame: SAD over every
+ * position and scale on a coarse pyramid level, then refinement of the best candidates
+ * level by level and a final normalized cross-correlation on full resolution
+ * @return true if the anchor was found. The located area is cached.
+ */
+bool locator_search(Locator *locator, const Frame *frame);
+
+/**
+ * @brief Cheap check that the anchor is still at the cached position
+ */
+bool locator_verify(Locator *locator, const Frame *frame);
+
+/**
+ * @brief Game area for this frame: the cached one while the verify-probe passes, otherwise
+ * the result of a new full search (at most one per LOCATOR_RETRY_MS). Until the anchor is
+ * found for the first time, and without an anchor, the game is assumed to fill the frame.
+ */
+GameArea locator_update(Locator *locator, const Frame *frame, uint64_t now);
+
+#endif
@@ -1,168 +1,590 @@
 #include <stdio.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
 #include <windows.h>
+#else
+#include <pthread.h>
+#endif
+#include "backend.h"
+#include "bot.h"
+#include "capture.h"
+#include "config.h"
+#include "coords.h"
+#include "frame.h"
+#include "locator.h"
+#include "match.h"
+#include "recording.h"
+#include "scheduler.h"
+#include "simulator.h"
+#include "telemetry.h"
+#include "wait.h"
 
-typedef struct {
-    int r;
-    int g;
-    int b;
-} RGBColor;
+// Delay before starting farm
+int initial_delay = 5;
+
+// How long the screen must stay still after a click before a dialog counts as opened/closed (ms)
+unsigned settle_time = 250;
+
+// Screen and input access
+Backend *backend = NULL;
+
+// Screen signatures, routines and farm modes from the data file
+GameConfig config = {0};
+
+// Finds the game in its window by the anchor (if the data file names one)
+Anchor anchor = {0};
+
+// Event recorder, NULL unless --telemetry was given (or a benchmark run measures it)
+Telemetry *telemetry = NULL;
+const char *telemetry_prefix = NULL;
+
+// Every game window with its own state machine, one input dispatcher for all
+Scheduler scheduler = {0};
+
+// Capture every game window on its own thread at this interval (ms), -1 to capture before each turn
+int capture_interval = -1;
+
+// Record the session into this file, NULL for none
+const char *record_path = NULL;
+
+// Restarts a stuck game client as the watchdog's last resort, NULL if there is no way to
+RestartHook restart_hook = NULL;
+void *restart_context = NULL;
+
+
+/**
+ * @brief Farm cycle for every game window: capture it, recognize it and do what the mode says for it
+ * @param until_ms Stop once the backend clock reaches it, 0 to run forever
+ * @param game_anchor Anchor to locate the game with, NULL if it fills its window
+ * @return false if no game window was found
+ */
+bool farm(const GameMode *mode, const Anchor *game_anchor, uint64_t until_ms) {
+    if (!scheduler_init(&scheduler, backend, &config, mode, game_anchor, settle_time, telemetry)) {
+        return false;
+    }
+    if (restart_hook != NULL) {
+        scheduler_set_restart(&scheduler, restart_hook, restart_context);
+    }
+    if (wait_verbose && scheduler.count > 1) {
+        printf("\nFarming %d game windows", scheduler.count);
+    }
+    if (capture_interval >= 0 && !scheduler_start_capture(&scheduler, (unsigned)capture_interval)) {
+        scheduler_free(&scheduler);
+        return false;
+    }
+    scheduler_run(&scheduler, until_ms);
+    scheduler_free(&scheduler);
+    return true;
+}
+
+
+// Restart commands still running, by game window
+static atomic_bool restart_running[SCHEDULER_MAX_INSTANCES];
 
 typedef struct {
-    int x;
-    int y;
-} Point;
+    int instance;
+    char command[CONFIG_COMMAND_LENGTH];
+} RestartJob;
 
-// Delay before starting farm
-int initial_delay = 5;
 
+/**
+ * @brief Copies the restart command, every {window} replaced by the number of the window
+ */
+static void restart_expand(char *out, size_t size, const char *command, int instance) {
+    static const char placeholder[] = "{window}";
+    size_t length = 0;
+    while (*command != '\0' && length + 1 < size) {
+        if (strncmp(command, placeholder, sizeof(placeholder) - 1) == 0) {
+            length += (size_t)snprintf(out + length, size - length, "%d", instance);
+            command += sizeof(placeholder) - 1;
+            if (length >= size) {
+                length = size - 1;
+            }
+        }
+        else {
+            out[length++] = *command++;
+        }
+    }
+    out[length] = '\0';
+}
 
-Point convert_to_UC(int base_x, int base_y) {
-    // Current screen resolution
-    int screenWidth = GetSystemMetrics(SM_CXSCREEN);
-    int screenHeight = GetSystemMetrics(SM_CYSCREEN);
 
-    // Base screen resolution
-    const int BASE_SCREEN_WIDTH = 1366;
-    const int BASE_SCREEN_HEIGHT = 768;
+#ifdef _WIN32
+static DWORD WINAPI restart_run(void *arg) {
+#else
+static void *restart_run(void *arg) {
+#endif
+    RestartJob *job = arg;
+    int status = system(job->command);
+    if (status != 0) {
+        printf("\nError: The restart command of window %d failed (%d).\n", job->instance, status);
+    }
+    atomic_store(&restart_running[job->instance], false);
+    free(job);
+    return 0;
+}
 
-    // Converting
-    double rel_x = (double)base_x / BASE_SCREEN_WIDTH;
-    double rel_y = (double)base_y / BASE_SCREEN_HEIGHT;
-    int target_x = (int)(rel_x * screenWidth);
-    int target_y = (int)(rel_y * screenHeight);
 
-    // Return a structure with universal coordinates
-    Point new_point = {target_x, target_y};
-    return new_point;
+/**
+ * @brief Restart hook of the real client: runs the restart command of the data file for
+ * the stuck window on a thread of its own, so the other windows keep farming meanwhile
+ * @return false if the command could not be started
+ */
+bool restart_command(void *ctx, int instance, const GameArea *window) {
+    (void)window;
+    if (instance < 0 || instance >= SCHEDULER_MAX_INSTANCES) {
+        return false;
+    }
+    // Still restarting from the last time: the watchdog gives it restart_ms before asking again
+    if (atomic_exchange(&restart_running[instance], true)) {
+        return true;
+    }
+    RestartJob *job = malloc(sizeof(RestartJob));
+    bool started = job != NULL;
+    if (started) {
+        job->instance = instance;
+        restart_expand(job->command, sizeof(job->command), (const char *)ctx, instance);
+#ifdef _WIN32
+        HANDLE thread = CreateThread(NULL, 0, restart_run, job, 0, NULL);
+        started = thread != NULL;
+        if (started) {
+            CloseHandle(thread);
+        }
+#else
+        pthread_t thread;
+        started = pthread_create(&thread, NULL, restart_run, job) == 0;
+        if (started) {
+            pthread_detach(thread);
+        }
+#endif
+    }
+    if (!started) {
+        free(job);
+        atomic_store(&restart_running[instance], false);
+    }
+    return started;
 }
 
 
 /**
- * @brief Returns the RGB color of the pixel at the specified screen coordinates (x, y).
- * @param x Horisontal coordinate (px)
- * @param y Vertical coordinate (px)
- * @return RGBColor structure. In case of an error (e.g., coordinates outside the screen)
- * returns {-1, -1, -1}.
+ * @brief Measures every supported region match kernel on a full simulated screen
+ * and checks they all count the same pixels
+ * @return Number of kernels that counted differently
  */
-RGBColor get_pixel_color(int x, int y) {
-    RGBColor color = {-1, -1, -1};
+int benchmark_match_kernels(void) {
+    Frame test = {0};
+    if (!frame_reserve(&test, BASE_SCREEN_WIDTH, BASE_SCREEN_HEIGHT)) {
+        return 1;
+    }
+    // Noise around the probed color so every channel comparison matters
+    uint32_t seed = 12345;
+    for (int i = 0; i < test.width * test.height; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        test.pixels[i] = 0xFF000000u | ((seed >> 8) & 0x0F0F0F) | 0xE0E8F0;
+    }
 
-    HDC hdc = GetDC(NULL);
-    if (hdc == NULL) {
-        printf("Error: Failed to get DC screen.\n");
-        return color;
+    RGBColor color = {230, 236, 246};
+    MatchKernel active = match_active_kernel();
+    int expected = -1, mismatches = 0;
+    for (int kernel = 0; kernel < MATCH_KERNEL_COUNT; kernel++) {
+        if (!match_use_kernel((MatchKernel)kernel)) {
+            continue;
+        }
+        int passes = 0, matching = 0;
+        uint64_t started = system_now_ms(), elapsed;
+        do {
+            matching = count_matching_pixels(&test, 0, 0, test.width, test.height, color, 8);
+            passes++;
+            elapsed = system_now_ms() - started;
+        } while (elapsed < 200);
+
+        if (expected < 0) {
+            expected = matching;
+        }
+        mismatches += matching != expected;
+        printf("\nRegion match %-6s %8.0f MP/s%s", match_kernel_name((MatchKernel)kernel),
+               (double)passes * test.width * test.height / (elapsed * 1000.0),
+               matching == expected ? "" : "  MISMATCH");
     }
+    match_use_kernel(active);
+    frame_free(&test);
+    return mismatches;
+}
 
-    // GetPixel returns a value of type COLORREF
-    COLORREF pixelColorRef = GetPixel(hdc, x, y);
 
-    // Very important: we free up the “canvas” that we took. If we don't do this, there will be a resource leak.
-    ReleaseDC(NULL, hdc);
+/**
+ * @brief Times the full search for the simulated game window at several scales and the
+ * verify-probe. Whether the locator finds the window is checked in tests/.
+ */
+void benchmark_locator(const Anchor *sim_anchor) {
+    enum { TRIALS = 5 };
+    Frame frame = {0};
+    int searches = 0;
+    uint64_t search_ms = 0;
+    bool verify_timed = false;
+    for (int i = 0; i < TRIALS; i++) {
+        SimulatorConfig sim_config;
+        simulator_default_config(&sim_config);
+        double scale = 0.4 + 0.6 * i / (TRIALS - 1);
+        sim_config.window_width = (int)(BASE_SCREEN_WIDTH * scale);
+        sim_config.window_height = (int)(BASE_SCREEN_HEIGHT * scale);
+        sim_config.window_x = (sim_config.screen_width - sim_config.window_width) / 2;
+        sim_config.window_y = (sim_config.screen_height - sim_config.window_height) / 2;
+
+        Backend *sim = simulator_create(&sim_config);
+        if (sim == NULL || !backend_snapshot(sim, &frame)) {
+            backend_destroy(sim);
+            continue;
+        }
+        Locator trial;
+        locator_init(&trial, sim_anchor);
+        uint64_t started = system_now_ms();
+        locator_search(&trial, &frame);
+        search_ms += system_now_ms() - started;
+        searches++;
+
+        if (!verify_timed && trial.located) {
+            verify_timed = true;
+            int verifies = 0;
+            started = system_now_ms();
+            do {
+                locator_verify(&trial, &frame);
+                verifies++;
+            } while (system_now_ms() - started < 100);
+            printf("\nWindow locator verify-probe: %6.2f us", (system_now_ms() - started) * 1000.0 / verifies);
+        }
+        locator_free(&trial);
+        backend_destroy(sim);
+    }
+    printf("\nWindow locator full search: %.0f ms", searches > 0 ? (double)search_ms / searches : 0.0);
+    frame_free(&frame);
+}
+
 
-    // GetPixel returns CLR_INVALID if the coordinates are outside the screen
-    if (pixelColorRef == CLR_INVALID) {
-        printf("Error: coordinates (%d, %d) are outside the screen.\n", x, y);
-        return color;
+/**
+ * @brief Times telemetry_record() from the farm thread while the flusher drains the buffer.
+ * Batches stay below the buffer capacity so no event is timed on the dropped path.
+ * @return Number of failed checks: an event was not flushed, the average over TELEMETRY_RECORD_BUDGET_NS
+ */
+int benchmark_telemetry(void) {
+    enum { BATCHES = 8, BATCH = TELEMETRY_CAPACITY / 2 };
+    Telemetry *recorder = telemetry_start(&config, NULL);
+    if (recorder == NULL) {
+        return 1;
     }
+    uint64_t record_us = 0;
+    for (int batch = 0; batch < BATCHES; batch++) {
+        uint64_t started = system_now_us();
+        for (int i = 0; i < BATCH; i++) {
+            telemetry_record(recorder, (TelemetryEventType)(i % TELEMETRY_EVENT_COUNT), 0, i % config.state_count,
+                             0, (uint32_t)i, started / 1000 + (uint64_t)i);
+        }
+        record_us += system_now_us() - started;
+        system_sleep_ms(2 * TELEMETRY_FLUSH_MS);
+    }
+    telemetry_stop(recorder);
+    double record_ns = record_us * 1000.0 / (BATCHES * BATCH);
+    printf("\nTelemetry record: %6.1f ns/event (budget %d), %llu of %d events flushed, %llu dropped",
+           record_ns, TELEMETRY_RECORD_BUDGET_NS, (unsigned long long)recorder->events, BATCHES * BATCH,
+           (unsigned long long)atomic_load(&recorder->dropped));
+    int failures = (recorder->events != BATCHES * BATCH) + (record_ns > TELEMETRY_RECORD_BUDGET_NS);
+    telemetry_free(recorder);
+    return failures;
+}
 
-    // Convert COLORREF (stored as 0x00BBGGRR) to the familiar RGB format using macros.
-    color.r = GetRValue(pixelColorRef);
-    color.g = GetGValue(pixelColorRef);
-    color.b = GetBValue(pixelColorRef);
 
-    return color;
+/**
+ * @brief One line of what the telemetry of the last run saw, to compare with the simulator's own count
+ */
+void print_telemetry(void) {
+    int battle = config_find_state(&config, "battle");
+    int world = config_find_state(&config, "world");
+    const TelemetryLatency *fight = &telemetry->phases[battle >= 0 ? battle : 0];
+    const TelemetryLatency *engage = &telemetry->waits[world >= 0 ? world : 0];
+    double elapsed_hours = (telemetry->last_ms - telemetry->first_ms) / 3600000.0;
+    printf("\n  telemetry: fights/hour: %6.1f  battle p50/p95/p99: %lu/%lu/%lu ms  engage p95: %lu ms"
+           "  retries: %llu  routines: %llu (unsettled steps: %llu)",
+           elapsed_hours > 0 ? telemetry->fights / elapsed_hours : 0.0,
+           (unsigned long)telemetry_percentile(fight, 50), (unsigned long)telemetry_percentile(fight, 95),
+           (unsigned long)telemetry_percentile(fight, 99), (unsigned long)telemetry_percentile(engage, 95),
+           (unsigned long long)telemetry->retries, (unsigned long long)telemetry->routines,
+           (unsigned long long)telemetry->routine_timeouts);
 }
 
 
 /**
- * @brief Compares two RGB colors
- * @return 1 (true) if all fields (r, g, b) are the same
- * @return 0 (false) if at least one field differs
+ * @brief Farms on a fresh simulator for a number of simulated hours
+ * @return false if the simulator could not be created
  */
-int are_colors_equal(RGBColor color1, RGBColor color2) {
-    // The expression below will automatically return 1 (true) 
-    // if all three conditions are true, and 0 (false) otherwise.
-    return (color1.r == color2.r && 
-            color1.g == color2.g && 
-            color1.b == color2.b);
+bool simulate(const SimulatorConfig *sim_config, const GameMode *mode, const Anchor *sim_anchor, double hours, SimulatorStats *stats) {
+    backend = simulator_create(sim_config);
+    if (backend == NULL) {
+        printf("\nError: Failed to create the simulator.\n");
+        return false;
+    }
+    bool ok = farm(mode, sim_anchor, backend->now_ms(backend) + (uint64_t)(hours * 3600000.0));
+    *stats = simulator_stats(backend);
+    backend_destroy(backend);
+    backend = NULL;
+    return ok;
 }
 
 
+#ifdef _WIN32
 /**
- * @brief Compares two colors taking into account tolerance (deviation)
- * @param color1
- * @param color2
- * @param tolerance Maximum deviation for EACH channel (R, G, B)
- * @return true (1) if the colors are similar, false (0) if not.
+ * @brief Probes per second on the real desktop: a GetDC/GetPixel/ReleaseDC round trip per probe,
+ * as the screen was read before frames, against one snapshot answering every probe of the
+ * data file's signatures
  */
-bool are_colors_similar(RGBColor color1, RGBColor color2, int tolerance) {
-    return (abs(color1.r - color2.r) <= tolerance &&
-            abs(color1.g - color2.g) <= tolerance &&
-            abs(color1.b - color2.b) <= tolerance);
+void benchmark_getpixel(void) {
+    Backend *desktop = backend_win32_create();
+    if (desktop == NULL) {
+        return;
+    }
+    ScreenMetrics screen = desktop->metrics(desktop);
+    GameArea whole = {0, 0, screen.width, screen.height, 0};
+    CoordTable coords = {0};
+    coord_table_set_custom(&coords, config.points, config.point_count);
+    coord_table_build(&coords, screen, whole);
+    Point points[MAX_STATES * MAX_SIGNATURE_PROBES];
+    int count = 0;
+    for (int i = 0; i < config.state_count; i++) {
+        for (int k = 0; k < config.states[i].probe_count; k++) {
+            points[count++] = coord_screen(&coords, config.states[i].probes[k].coord);
+        }
+    }
+    if (count == 0) {
+        backend_destroy(desktop);
+        return;
+    }
+
+    uint64_t getpixel_probes = 0, started = system_now_us(), elapsed = 1;
+    do {
+        HDC dc = GetDC(NULL);
+        if (dc == NULL) {
+            break;
+        }
+        const Point *point = &points[getpixel_probes % count];
+        volatile COLORREF color = GetPixel(dc, point->x, point->y);
+        (void)color;
+        ReleaseDC(NULL, dc);
+        getpixel_probes++;
+        elapsed = system_now_us() - started;
+    } while (elapsed < 500000);
+    double getpixel_rate = getpixel_probes * 1000000.0 / elapsed;
+
+    Frame frame = {0};
+    uint64_t snapshot_probes = 0;
+    volatile int sink = 0;
+    started = system_now_us();
+    elapsed = 1;
+    do {
+        if (!backend_snapshot(desktop, &frame)) {
+            break;
+        }
+        for (int i = 0; i < count; i++) {
+            sink += frame_probe(&frame, points[i].x, points[i].y).r;
+        }
+        snapshot_probes += count;
+        elapsed = system_now_us() - started;
+    } while (elapsed < 500000);
+    double snapshot_rate = snapshot_probes * 1000000.0 / elapsed;
+
+    printf("\nDesktop probes: GetPixel %9.0f/s  snapshot %9.0f/s (%d probes per %dx%d capture)  %.1fx",
+           getpixel_rate, snapshot_rate, count, screen.width, screen.height,
+           getpixel_rate > 0 ? snapshot_rate / getpixel_rate : 0.0);
+    frame_free(&frame);
+    backend_destroy(desktop);
 }
+#endif
 
 
 /**
- * @brief Simulates a moving mouse to the specified screen coordinates (x, y)
- * @param x Horisontal coordinate (px)
- * @param y Vertical coordinate (px)
+ * @brief Runs every farm type against the simulated client at accelerated time
+ * and reports fights/hour and the time the client sat waiting for the bot
+ * @param hours Simulated duration of each run
+ * @return 0 if the simulator ran and the kernels and the telemetry passed their checks.
+ * The tests of the bot are in tests/, run with make test.
  */
-void move(int x, int y) {
-    // Current screen resolution
-    int screenWidth = GetSystemMetrics(SM_CXSCREEN);
-    int screenHeight = GetSystemMetrics(SM_CYSCREEN);
-
-    // Convert pixel coordinates (x, y) to absolute coordinates (0-65535)
-    // MOUSEEVENTF_ABSOLUTE requires this normalized format.
-    double absoluteX = (double)x / screenWidth * 65535.0;
-    double absoluteY = (double)y / screenHeight * 65535.0;
-
-    // moving mouse
-    INPUT input_move = {0};
-    input_move.type = INPUT_MOUSE;
-    input_move.mi.dx = (LONG)absoluteX;
-    input_move.mi.dy = (LONG)absoluteY;
-    input_move.mi.dwFlags = MOUSEEVENTF_MOVE | MOUSEEVENTF_ABSOLUTE;
-    SendInput(1, &input_move, sizeof(INPUT));
-    Sleep(50); 
+int run_benchmark(double hours) {
+    wait_verbose = false;
+
+    printf("\n----------------------------------------------------------------------------------------");
+    int failures = benchmark_match_kernels();
+#ifdef _WIN32
+    benchmark_getpixel();
+#endif
+
+    Anchor sim_anchor;
+    if (!simulator_anchor(&sim_anchor)) {
+        printf("\nError: Failed to create the simulator.\n");
+        return 1;
+    }
+    benchmark_locator(&sim_anchor);
+    failures += benchmark_telemetry();
+
+    printf("\nSimulated benchmark, %.1f h per farm type, game in a 1024x576 window", hours);
+    for(int i = 0; i < config.mode_count; i++) {
+        SimulatorConfig sim_config;
+        simulator_default_config(&sim_config);
+        sim_config.window_x = 171;
+        sim_config.window_y = 96;
+        sim_config.window_width = 1024;
+        sim_config.window_height = 576;
+        // A mode that trains the team in batches needs a team to fill them
+        if (config.modes[i].batch > 0) {
+            sim_config.team_size = SIM_MAX_TEAM;
+        }
+
+        // Every farm type gets its own recording, <prefix>-<n>.csv/.json with --telemetry
+        char prefix[CONFIG_PATH_LENGTH];
+        if (telemetry_prefix != NULL) {
+            snprintf(prefix, sizeof(prefix), "%s-%d", telemetry_prefix, i + 1);
+        }
+        telemetry = telemetry_start(&config, telemetry_prefix != NULL ? prefix : NULL);
+
+        SimulatorStats stats;
+        bool ok = simulate(&sim_config, &config.modes[i], &sim_anchor, hours, &stats);
+        telemetry_stop(telemetry);
+        if (!ok) {
+            telemetry_free(telemetry);
+            anchor_free(&sim_anchor);
+            return 1;
+        }
+        double elapsed_hours = stats.elapsed_ms / 3600000.0;
+        printf("\n%-34s fights/hour: %6.1f  trainings: %4d  idle per cycle: %6.0f ms  missed clicks: %d",
+               config.modes[i].title, stats.fights / elapsed_hours, stats.trainings,
+               stats.fights > 0 ? (double)stats.idle_ms / stats.fights : 0.0, stats.missed_clicks);
+        if (telemetry != NULL) {
+            print_telemetry();
+        }
+        telemetry_free(telemetry);
+        telemetry = NULL;
+    }
+
+    // Several clients tiled on a 2732x1536 desktop, all farmed by one scheduler
+    printf("\nMulti-client scaling, %s", config.modes[0].title);
+    for (int clients = 1; clients <= 8; clients *= 2) {
+        SimulatorConfig sim_config;
+        simulator_default_config(&sim_config);
+        sim_config.screen_width = 2 * BASE_SCREEN_WIDTH;
+        sim_config.screen_height = 2 * BASE_SCREEN_HEIGHT;
+        sim_config.clients = clients;
+
+        SimulatorStats stats;
+        if (!simulate(&sim_config, &config.modes[0], &sim_anchor, hours, &stats)) {
+            anchor_free(&sim_anchor);
+            return 1;
+        }
+        double fights_per_hour = stats.fights / (stats.elapsed_ms / 3600000.0);
+        printf("\n%2d client(s)                       fights/hour: %6.1f  per client: %6.1f  idle per cycle: %6.0f ms  missed clicks: %d",
+               clients, fights_per_hour, fights_per_hour / clients,
+               stats.fights > 0 ? (double)stats.idle_ms / stats.fights : 0.0, stats.missed_clicks);
+    }
+    if (failures > 0) {
+        printf("\nError: %d benchmark checks failed.", failures);
+    }
+    printf("\n");
+
+    anchor_free(&sim_anchor);
+    return failures == 0 ? 0 : 1;
 }
 
 
 /**
- * @brief Simulates a left mouse click at the specified screen coordinates (x, y)
- * @param x Horisontal coordinate (px)
- * @param y Vertical coordinate (px)
+ * @brief Runs a farm type over a recorded session at full speed, as a regression test of the
+ * screen recognition: the bot must send the recorded input for the recorded frames
+ * @return 0 if the replay followed the recording, 1 if it diverged
  */
-void click(int x, int y) {
-    // Current screen resolution
-    int screenWidth = GetSystemMetrics(SM_CXSCREEN);
-    int screenHeight = GetSystemMetrics(SM_CYSCREEN);
-
-    // Convert pixel coordinates (x, y) to absolute coordinates (0-65535)
-    // MOUSEEVENTF_ABSOLUTE requires this normalized format.
-    double absoluteX = (double)x / screenWidth * 65535.0;
-    double absoluteY = (double)y / screenHeight * 65535.0;
-
-    // Clicking and releasing the mouse button
-    INPUT input_down = {0};
-    input_down.type = INPUT_MOUSE;
-    input_down.mi.dwFlags = MOUSEEVENTF_LEFTDOWN;
-    SendInput(1, &input_down, sizeof(INPUT));
-    Sleep(100); 
-    INPUT input_up = {0};
-    input_up.type = INPUT_MOUSE;
-    input_up.mi.dwFlags = MOUSEEVENTF_LEFTUP;
-    SendInput(1, &input_up, sizeof(INPUT));
+int run_replay(const char *path, int choice) {
+    if (choice < 1 || choice > config.mode_count) {
+        printf("\nError: Wrong farm type %d, enter a number from 1 to %d.\n", choice, config.mode_count);
+        return 1;
+    }
+    backend = replay_create(path);
+    if (backend == NULL) {
+        return 1;
+    }
+    const Anchor *game_anchor = NULL;
+    if (config.anchor_path[0] != '\0') {
+        if (!anchor_load(&anchor, config.anchor_path, config.anchor_width, config.anchor_height, config.anchor_x, config.anchor_y)) {
+            backend_destroy(backend);
+            return 1;
+        }
+        game_anchor = &anchor;
+    }
+    wait_verbose = false;
+
+    RecordingStats stats = replay_stats(backend);
+    uint64_t started = system_now_us();
+    bool ok = farm(&config.modes[choice - 1], game_anchor, stats.last_ms + 1);
+    uint64_t elapsed_us = system_now_us() - started;
+    stats = replay_stats(backend);
+    printf("\nReplayed %u of %u frames (%.1f min of play) in %.2f s: %.0f frames/s"
+           "\nInput: %u of %u sequences as recorded, %u divergences\n",
+           stats.replayed, stats.frames, (stats.last_ms - stats.first_ms) / 60000.0, elapsed_us / 1e6,
+           elapsed_us > 0 ? stats.replayed * 1e6 / elapsed_us : 0.0, stats.matched, stats.inputs, stats.diverged);
+
+    anchor_free(&anchor);
+    backend_destroy(backend);
+    backend = NULL;
+    return ok && stats.diverged == 0 && stats.matched == stats.inputs ? 0 : 1;
 }
 
 
-int main() {
-    // Current screen resolution
-    int screenWidth = GetSystemMetrics(SM_CXSCREEN);
-    int screenHeight = GetSystemMetrics(SM_CYSCREEN);
-    int choice, target_x = 0, target_y = 0, start_fight_x_coord = 0, start_fight_y_coord = 0, golden_line_x_coord = 0, golden_line_y_coord = 0;
+int main(int argc, char *argv[]) {
+    // --config <path>: screen signatures and farm modes, those of the simulated client for --benchmark
+    const char *config_path = NULL;
+    if (argc > 2 && strcmp(argv[1], "--config") == 0) {
+        config_path = argv[2];
+        argc -= 2;
+        argv += 2;
+    }
+
+    // --telemetry <prefix>: record every event into <prefix>.csv and keep <prefix>.json up to date
+    if (argc > 2 && strcmp(argv[1], "--telemetry") == 0) {
+        telemetry_prefix = argv[2];
+        argc -= 2;
+        argv += 2;
+    }
+
+    // --capture <ms>: capture every game window on its own thread at this interval
+    if (argc > 2 && strcmp(argv[1], "--capture") == 0) {
+        capture_interval = atoi(argv[2]);
+        argc -= 2;
+        argv += 2;
+    }
+
+    // --record <path>: record the captured frames and the input sent into a file
+    if (argc > 2 && strcmp(argv[1], "--record") == 0) {
+        record_path = argv[2];
+        argc -= 2;
+        argv += 2;
+    }
+    if (record_path != NULL && capture_interval >= 0) {
+        printf("\nError: --record can't be combined with --capture.\n");
+        return 1;
+    }
+
+    bool benchmark = argc > 1 && strcmp(argv[1], "--benchmark") == 0;
+    if (!config_load(&config, config_path != NULL ? config_path : benchmark ? "simulator.cfg" : "miscrits.cfg")) {
+        return 1;
+    }
+
+    // --replay <path> <farm type>: run the farm type over a recording instead of the game
+    if (argc > 3 && strcmp(argv[1], "--replay") == 0) {
+        return run_replay(argv[2], atoi(argv[3]));
+    }
+
+    // --benchmark [hours]: run all farm types against the simulated client instead of the game
+    if (benchmark) {
+        return run_benchmark(argc > 2 ? atof(argv[2]) : 1.0);
+    }
+
+    int choice;
     printf("\n----------------------------------------------------------------------------------------");
     printf("\n ____    ____  _____   ______     ______  _______     _____  _________   ______   ");
     printf("\n|_   \\  /   _||_   _|.' ____ \\  .' ___  ||_   __ \\   |_   _||  _   _  |.' ____ \\ ");
@@ -200,246 +622,87 @@ int main() {
     printf("\n\t\tMiscrit for training on 2nd slot");
     printf("\n\t\tDisabled battle animations");
     printf("\n\t\t34 platinum");
+    // Farm types added in the data file
+    for(int i = 3; i < config.mode_count; i++) {
+        printf("\n----------------------------------------------------------------------------------------");
+        printf("\n%d - %s", i + 1, config.modes[i].title);
+    }
     while(1) {
         printf("\n----------------------------------------------------------------------------------------");
         printf("\nSelect farm type: ");
         if (scanf("%d", &choice) == 1) {
-            if (choice == 1 || choice == 2 || choice == 3) {
+            if (choice >= 1 && choice <= config.mode_count) {
                 break; 
             }
             else {
-                printf("\nWrong option! Enter a number 1, 2 or 3\n");
+                printf("\nWrong option! Enter a number from 1 to %d\n", config.mode_count);
             }
         }
         else {
-            printf("\nWrong option! Enter a number 1, 2 or 3\n");
+            printf("\nWrong option! Enter a number from 1 to %d\n", config.mode_count);
             int c;
             while ((c = getchar()) != '\n' && c != EOF);
         }
     }
 
+#ifdef _WIN32
+    backend = backend_win32_create();
+#else
+    printf("\nError: Farming the live game requires Windows. Use --benchmark to run against the simulator.\n");
+    return 1;
+#endif
+    if (backend == NULL) {
+        printf("\nError: Failed to initialize screen capture.\n");
+        return 1;
+    }
 
-
-    // Cycle for gold farm
-    if(choice == 1) {
-        printf("\nStarting gold farm...");
-
-        // Base screen resolution
-        const int BASE_SCREEN_WIDTH = 1366;
-        const int BASE_SCREEN_HEIGHT = 768;
-
-        // Delay before starting
-        printf("\nStarting in %d seconds...", initial_delay);
-        Sleep(initial_delay * 1000);
-
-        int positions[3][2] = {{687, 339}, {414, 680}, {682, 584}};
-        int positions_length = sizeof(positions) / sizeof(positions[0]);
-        int intervals[] = {7000, 8000, 10000};
-        int start_fight_coodinates[] = {510, 67};
-        RGBColor start_fight_color = {226, 237, 255};
-
-        // Start cycle
-        while(1) {
-            for(int i = 0; i < positions_length; i++) {
-                // Setting universal fight coordinates
-                start_fight_x_coord = convert_to_UC(start_fight_coodinates[0], start_fight_coodinates[1]).x;
-                start_fight_y_coord = convert_to_UC(start_fight_coodinates[0], start_fight_coodinates[1]).y;
-                // If fight NOT starting
-                if(i == 1 && !are_colors_equal(get_pixel_color(start_fight_x_coord, start_fight_y_coord), start_fight_color)) {
-                    while(1) {
-                        // Waiting for cooldown an additional time
-                        Sleep(intervals[2]+5000);
-
-                        // Setting coodinates and converting to universal resolution
-                        target_x = convert_to_UC(positions[0][0], positions[0][1]).x;
-                        target_y = convert_to_UC(positions[0][0], positions[0][1]).y;
-
-                        // Click on object with miscrit
-                        move(target_x, target_y);
-                        click(target_x, target_y);
-                        Sleep(intervals[0]);
-
-                        // Setting universal fight coordinates
-                        start_fight_x_coord = convert_to_UC(start_fight_coodinates[0], start_fight_coodinates[1]).x;
-                        start_fight_y_coord = convert_to_UC(start_fight_coodinates[0], start_fight_coodinates[1]).y;
-                        // If fight is starting
-                        if(are_colors_equal(get_pixel_color(start_fight_x_coord, start_fight_y_coord), start_fight_color)) {
-                            // Setting coodinates and converting to universal resolution
-                            target_x = convert_to_UC(positions[i][0], positions[i][1]).x;
-                            target_y = convert_to_UC(positions[i][0], positions[i][1]).y;
-
-                            // Click on miscrits ability on fight
-                            move(target_x, target_y);
-                            click(target_x, target_y);
-                            Sleep(intervals[i]);
-                            break;
-                        }
-                        else {
-                            continue;
-                        }
-                    }
-                }
-
-                // Setting coodinates and converting to universal resolution
-                target_x = convert_to_UC(positions[i][0], positions[i][1]).x;
-                target_y = convert_to_UC(positions[i][0], positions[i][1]).y;
-
-                // Click on object with miscrit or closing fight window
-                move(target_x, target_y);
-                click(target_x, target_y);
-                Sleep(intervals[i]);
-            }
+    const Anchor *game_anchor = NULL;
+    if (config.anchor_path[0] != '\0') {
+        if (!anchor_load(&anchor, config.anchor_path, config.anchor_width, config.anchor_height, config.anchor_x, config.anchor_y)) {
+            backend_destroy(backend);
+            return 1;
         }
+        game_anchor = &anchor;
     }
 
+    printf("\nStarting %s...", config.modes[choice - 1].title);
 
-    // Cycle for miscrit training
-    if(choice == 2 || choice == 3) {
-        if(choice == 2) printf("\nStarting miscrit training...");
-        if(choice == 3) printf("\nStarting miscrit training with platinum...");
-        
-        // Base screen resolution
-        const int BASE_SCREEN_WIDTH = 1366;
-        const int BASE_SCREEN_HEIGHT = 768;
-
-        // Delay before starting
-        printf("\nStarting in %d seconds...", initial_delay);
-        Sleep(initial_delay * 1000);
-
-        int positions[3][2] = {{687, 339}, {414, 680}, {682, 584}};
-        int positions_length = sizeof(positions) / sizeof(positions[0]);
-        int intervals[3] = {7000, 10000, 10000};
-        int start_fight_coodinates[] = {510, 67};
-        int golden_line_coordinates[] = {565, 305};
-        RGBColor start_fight_color = {226, 237, 255};
-        RGBColor ready_to_train_color = {237, 188, 87};
-        RGBColor new_ability_color = {103, 122, 144};
-        RGBColor new_miscrit_evolution_color = {107, 138, 19};
-        RGBColor new_user_level_color = {107, 138, 19};
-
-        // Start cycle
-        while(1) {
-            bool ready_to_train = false;
-            for(int i = 0; i < positions_length; i++) {
-                // Setting universal fight coordinates
-                start_fight_x_coord = convert_to_UC(start_fight_coodinates[0], start_fight_coodinates[1]).x;
-                start_fight_y_coord = convert_to_UC(start_fight_coodinates[0], start_fight_coodinates[1]).y;
-                // If fight NOT starting
-                if(i == 1 && !are_colors_equal(get_pixel_color(start_fight_x_coord, start_fight_y_coord), start_fight_color)) {
-                    while(1) {
-                        // Waiting for cooldown an additional time
-                        Sleep(intervals[2]+5000);
-
-                        // Setting coodinates and converting to universal resolution
-                        target_x = convert_to_UC(positions[0][0], positions[0][1]).x;
-                        target_y = convert_to_UC(positions[0][0], positions[0][1]).y;
-
-                        // Click on object with miscrit
-                        move(target_x, target_y);
-                        click(target_x, target_y);
-                        Sleep(intervals[0]);
-
-                        // Setting universal fight coordinates
-                        start_fight_x_coord = convert_to_UC(start_fight_coodinates[0], start_fight_coodinates[1]).x;
-                        start_fight_y_coord = convert_to_UC(start_fight_coodinates[0], start_fight_coodinates[1]).y;
-                        // If fight is starting
-                        if(are_colors_equal(get_pixel_color(510, 67), start_fight_color)) { // If fight is starting
-                            // Setting coodinates and converting to universal resolution
-                            target_x = convert_to_UC(positions[i][0], positions[i][1]).x;
-                            target_y = convert_to_UC(positions[i][0], positions[i][1]).y;
-
-                            // Click on miscrits ability on fight
-                            move(target_x, target_y);
-                            click(target_x, target_y);
-                            Sleep(intervals[i]);
-                            break;
-                        }
-                        else {
-                            continue;
-                        }
-                    }
-                }
-                
-                // Setting universal golden line coordinates
-                golden_line_x_coord = convert_to_UC(golden_line_coordinates[0], golden_line_coordinates[1]).x;
-                golden_line_y_coord = convert_to_UC(golden_line_coordinates[0], golden_line_coordinates[1]).y;
-                // If there is a gold line on the miscrit after the battle, set the parameter to “ready to train”
-                if(i == 2 && are_colors_similar(get_pixel_color(golden_line_x_coord, golden_line_y_coord), ready_to_train_color, 10)) {
-                    ready_to_train = true;
-                }
-
-                // Setting coodinates and converting to universal resolution
-                target_x = convert_to_UC(positions[i][0], positions[i][1]).x;
-                target_y = convert_to_UC(positions[i][0], positions[i][1]).y;
-                // Click on object with miscrit, fight ability or closing fight window
-                move(target_x, target_y);
-                click(target_x, target_y);
-                Sleep(intervals[i]);
-
-                // If miscrit ready to train
-                if(ready_to_train) {
-                    // click on blue button
-                    move(convert_to_UC(614, 55).x, convert_to_UC(614, 55).y);
-                    click(convert_to_UC(614, 55).x, convert_to_UC(614, 55).y);
-                    Sleep(2000);
-                    // select miscrit
-                    move(convert_to_UC(461, 222).x, convert_to_UC(461, 222).y);
-                    click(convert_to_UC(461, 222).x, convert_to_UC(461, 222).y);
-                    Sleep(1000);
-                    // click train
-                    move(convert_to_UC(697, 154).x, convert_to_UC(697, 154).y);
-                    click(convert_to_UC(697, 154).x, convert_to_UC(697, 154).y);
-                    Sleep(1000);
-                    // if was setting training WITHOUT platinum
-                    if(choice == 2) {
-                        // double closing train window
-                        move(convert_to_UC(796, 625).x, convert_to_UC(796, 625).y);
-                        click(convert_to_UC(796, 625).x, convert_to_UC(796, 625).y);
-                        Sleep(1000);
-                        move(convert_to_UC(796, 625).x, convert_to_UC(796, 625).y);
-                        click(convert_to_UC(796, 625).x, convert_to_UC(796, 625).y);
-                        Sleep(1000);
-                    }
-                    // if was setting training WITH platinum
-                    if(choice == 3) {
-                        // double click on training with platinum
-                        move(convert_to_UC(620, 626).x, convert_to_UC(620, 626).y);
-                        click(convert_to_UC(620, 626).x, convert_to_UC(620, 626).y);
-                        Sleep(1000);
-                        move(convert_to_UC(620, 626).x, convert_to_UC(620, 626).y);
-                        click(convert_to_UC(620, 626).x, convert_to_UC(620, 626).y);
-                        Sleep(3000);
-                        move(convert_to_UC(683, 626).x, convert_to_UC(683, 626).y);
-                        click(convert_to_UC(683, 626).x, convert_to_UC(683, 626).y);
-                        Sleep(1000);
-                    }
-                    // if miscrit has received a new ablity, close the window
-                    if(are_colors_equal(get_pixel_color(convert_to_UC(791, 342).x, convert_to_UC(791, 342).y), new_ability_color)) {
-                        move(convert_to_UC(792, 503).x, convert_to_UC(792, 503).y);
-                        click(convert_to_UC(792, 503).x, convert_to_UC(792, 503).y);
-                        Sleep(1000);
-                    }
-                    // if miscrit has received a new evolution, close the window
-                    if(are_colors_equal(get_pixel_color(convert_to_UC(479, 164).x, convert_to_UC(479, 164).y), new_miscrit_evolution_color)) {
-                        move(convert_to_UC(682, 591).x, convert_to_UC(682, 591).y);
-                        click(convert_to_UC(682, 591).x, convert_to_UC(682, 591).y);
-                        Sleep(1000);
-                    }
-                    // closing general train window
-                    move(convert_to_UC(980, 123).x, convert_to_UC(980, 123).y);
-                    click(convert_to_UC(980, 123).x, convert_to_UC(980, 123).y);
-                    Sleep(1000);
-                    // if player has reached a new level, close the window
-                    if(are_colors_equal(get_pixel_color(convert_to_UC(575, 237).x, convert_to_UC(575, 237).y), new_user_level_color)) {
-                        move(convert_to_UC(684, 516).x, convert_to_UC(684, 516).y);
-                        click(convert_to_UC(684, 516).x, convert_to_UC(684, 516).y);
-                        Sleep(1000);
-                    }
-                    ready_to_train = false;
-                }
-            }
+    // Delay before starting
+    printf("\nStarting in %d seconds...", initial_delay);
+    backend->sleep_ms(backend, initial_delay * 1000);
+
+    if (telemetry_prefix != NULL) {
+        telemetry = telemetry_start(&config, telemetry_prefix);
+        if (telemetry == NULL) {
+            anchor_free(&anchor);
+            backend_destroy(backend);
+            return 1;
         }
     }
-    
-    return 0;
-}
\ No newline at end of file
+
+    // The recorder stands in for the screen and passes everything on to it
+    Backend *screen = backend;
+    if (record_path != NULL) {
+        backend = recorder_create(screen, record_path);
+        if (backend == NULL) {
+            telemetry_free(telemetry);
+            anchor_free(&anchor);
+            backend_destroy(screen);
+            return 1;
+        }
+    }
+
+    if (config.watchdog.restart[0] != '\0') {
+        restart_hook = restart_command;
+        restart_context = config.watchdog.restart;
+    }
+    bool farmed = farm(&config.modes[choice - 1], game_anchor, 0);
+
+    telemetry_free(telemetry);
+    anchor_free(&anchor);
+    if (backend != screen) {
+        backend_destroy(backend);
+    }
+    backend_destroy(screen);
+    return farmed ? 0 : 1;
+}
@@ -0,0 +1,199 @@
+#include <stdint.h>
+#include "match.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define MATCH_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define MATCH_TARGET_AVX2
+#else
+#define MATCH_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+typedef int (*MatchRowFunction)(const uint32_t *pixels, int count, uint32_t color, uint32_t tolerance);
+
+static MatchKernel active_kernel = MATCH_SCALAR;
+static bool kernel_chosen = false;
+
+
+/**
+ * @brief Scalar kernel: one pixel at a time, also handles the tails of the vector kernels
+ */
+static int match_row_scalar(const uint32_t *pixels, int count, uint32_t color, uint32_t tolerance) {
+    int tol = (int)(tolerance & 0xFF);
+    int r = (int)((color >> 16) & 0xFF), g = (int)((color >> 8) & 0xFF), b = (int)(color & 0xFF);
+    int matches = 0;
+
+    for (int i = 0; i < count; i++) {
+        uint32_t pixel = pixels[i];
+        int dr = (int)((pixel >> 16) & 0xFF) - r;
+        int dg = (int)((pixel >> 8) & 0xFF) - g;
+        int db = (int)(pixel & 0xFF) - b;
+        matches += (dr <= tol && dr >= -tol && dg <= tol && dg >= -tol && db <= tol && db >= -tol);
+    }
+    return matches;
+}
+
+
+#ifdef MATCH_X86
+/**
+ * @brief SSE2 kernel: 4 pixels per step. |a - b| per byte is (a -sat b) | (b -sat a);
+ * a byte is within tolerance when (|a - b| -sat tolerance) == 0. The alpha byte has
+ * tolerance 255, so it always passes.
+ */
+static int match_row_sse2(const uint32_t *pixels, int count, uint32_t color, uint32_t tolerance) {
+    const __m128i target = _mm_set1_epi32((int)color);
+    const __m128i limit = _mm_set1_epi32((int)tolerance);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i all = _mm_set1_epi32(-1);
+    int matches = 0, i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        __m128i block = _mm_loadu_si128((const __m128i *)(pixels + i));
+        __m128i diff = _mm_or_si128(_mm_subs_epu8(block, target), _mm_subs_epu8(target, block));
+        __m128i within = _mm_cmpeq_epi8(_mm_subs_epu8(diff, limit), zero);
+        __m128i pixel_ok = _mm_cmpeq_epi32(within, all);
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(pixel_ok));
+        matches += (mask & 1) + ((mask >> 1) & 1) + ((mask >> 2) & 1) + ((mask >> 3) & 1);
+    }
+    return matches + match_row_scalar(pixels + i, count - i, color, tolerance);
+}
+
+
+/**
+ * @brief AVX2 kernel: the SSE2 kernel on 8 pixels per step
+ */
+MATCH_TARGET_AVX2
+static int match_row_avx2(const uint32_t *pixels, int count, uint32_t color, uint32_t tolerance) {
+    const __m256i target = _mm256_set1_epi32((int)color);
+    const __m256i limit = _mm256_set1_epi32((int)tolerance);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i all = _mm256_set1_epi32(-1);
+    int matches = 0, i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        __m256i block = _mm256_loadu_si256((const __m256i *)(pixels + i));
+        __m256i diff = _mm256_or_si256(_mm256_subs_epu8(block, target), _mm256_subs_epu8(target, block));
+        __m256i within = _mm256_cmpeq_epi8(_mm256_subs_epu8(diff, limit), zero);
+        __m256i pixel_ok = _mm256_cmpeq_epi32(within, all);
+        unsigned mask = (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(pixel_ok));
+        // Popcount of 8 bits without depending on POPCNT
+        mask = mask - ((mask >> 1) & 0x55u);
+        mask = (mask & 0x33u) + ((mask >> 2) & 0x33u);
+        matches += (int)((mask + (mask >> 4)) & 0x0Fu);
+    }
+    return matches + match_row_scalar(pixels + i, count - i, color, tolerance);
+}
+
+
+static bool cpu_has_avx2(void) {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    // OSXSAVE and AVX, then the OS must save the YMM state
+    if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0) return false;
+    if ((_xgetbv(0) & 0x6) != 0x6) return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+
+static bool cpu_has_sse2(void) {
+#if defined(__x86_64__) || defined(_M_X64)
+    return true;
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[3] & (1 << 26)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2");
+#endif
+}
+#endif
+
+
+bool match_kernel_supported(MatchKernel kernel) {
+    switch (kernel) {
+        case MATCH_SCALAR:
+            return true;
+#ifdef MATCH_X86
+        case MATCH_SSE2:
+            return cpu_has_sse2();
+        case MATCH_AVX2:
+            return cpu_has_avx2();
+#endif
+        default:
+            return false;
+    }
+}
+
+
+bool match_use_kernel(MatchKernel kernel) {
+    if (!match_kernel_supported(kernel)) {
+        return false;
+    }
+    active_kernel = kernel;
+    kernel_chosen = true;
+    return true;
+}
+
+
+MatchKernel match_active_kernel(void) {
+    if (!kernel_chosen) {
+        // The fastest one first
+        if (!match_use_kernel(MATCH_AVX2) && !match_use_kernel(MATCH_SSE2)) {
+            match_use_kernel(MATCH_SCALAR);
+        }
+    }
+    return active_kernel;
+}
+
+
+const char *match_kernel_name(MatchKernel kernel) {
+    static const char *names[MATCH_KERNEL_COUNT] = {"scalar", "sse2", "avx2"};
+    return kernel < MATCH_KERNEL_COUNT ? names[kernel] : "unknown";
+}
+
+
+int count_matching_pixels(const Frame *frame, int x, int y, int width, int height, RGBColor color, int tolerance) {
+    // Clipping the rectangle to the frame
+    int x0 = x - frame->x, y0 = y - frame->y;
+    int x1 = x0 + width, y1 = y0 + height;
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 > frame->width) x1 = frame->width;
+    if (y1 > frame->height) y1 = frame->height;
+    if (frame->pixels == NULL || x1 <= x0 || y1 <= y0) {
+        return 0;
+    }
+
+    MatchRowFunction match_row = match_row_scalar;
+#ifdef MATCH_X86
+    switch (match_active_kernel()) {
+        case MATCH_AVX2: match_row = match_row_avx2; break;
+        case MATCH_SSE2: match_row = match_row_sse2; break;
+        default: break;
+    }
+#endif
+
+    // Per-byte tolerance in pixel layout; alpha is never compared
+    if (tolerance < 0) tolerance = 0;
+    if (tolerance > 255) tolerance = 255;
+    uint32_t limit = 0xFF000000u | ((uint32_t)tolerance << 16) | ((uint32_t)tolerance << 8) | (uint32_t)tolerance;
+    uint32_t target = rgb_to_pixel(color);
+
+    int matches = 0;
+    for (int row = y0; row < y1; row++) {
+        matches += match_row(frame->pixels + (size_t)row * frame->stride + x0, x1 - x0, target, limit);
+    }
+    return matches;
+}
@@ -0,0 +1,36 @@
+#ifndef MATCH_H
+#define MATCH_H
+
+#include <stdbool.h>
+#include "frame.h"
+
+typedef enum {
+    MATCH_SCALAR,
+    MATCH_SSE2,
+    MATCH_AVX2,
+    MATCH_KERNEL_COUNT
+} MatchKernel;
+
+/**
+ * @brief Counts the pixels of the rectangle (x, y, width, height) in screen coordinates
+ * whose R, G and B each deviate from color by at most tolerance. The rectangle is clipped
+ * to the frame. Uses the fastest kernel the CPU supports (picked on first use).
+ */
+int count_matching_pixels(const Frame *frame, int x, int y, int width, int height, RGBColor color, int tolerance);
+
+/**
+ * @brief Whether the CPU (and the build) can run a kernel
+ */
+bool match_kernel_supported(MatchKernel kernel);
+
+/**
+ * @brief Forces a kernel, e.g. to compare them
+ * @return false if the kernel is not supported (the active one is kept)
+ */
+bool match_use_kernel(MatchKernel kernel);
+
+MatchKernel match_active_kernel(void);
+
+const char *match_kernel_name(MatchKernel kernel);
+
+#endif
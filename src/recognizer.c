@@ -0,0 +1,63 @@
+#include "match.h"
+#include "recognizer.h"
+
+
+typedef struct {
+    int x;
+    int y;
+    int width;
+    int height;
+} ProbeRect;
+
+
+/**
+ * @brief Screen pixels a probe looks at: its region scaled and centered on the coordinate, or one pixel
+ */
+static ProbeRect probe_rect(const SignatureProbe *probe, const CoordTable *coords) {
+    Point center = coord_screen(coords, probe->coord);
+    if (probe->width <= 0) {
+        ProbeRect pixel = {center.x, center.y, 1, 1};
+        return pixel;
+    }
+    int width = (int)(probe->width * coords->scale_x + 0.5), height = (int)(probe->height * coords->scale_y + 0.5);
+    if (width < 1) width = 1;
+    if (height < 1) height = 1;
+    ProbeRect region = {center.x - width / 2, center.y - height / 2, width, height};
+    return region;
+}
+
+
+bool probe_matches(const SignatureProbe *probe, const CoordTable *coords, const Frame *frame) {
+    ProbeRect rect = probe_rect(probe, coords);
+    if (probe->width <= 0) {
+        return are_colors_similar(frame_probe(frame, rect.x, rect.y), probe->color, probe->tolerance);
+    }
+    int matching = count_matching_pixels(frame, rect.x, rect.y, rect.width, rect.height, probe->color, probe->tolerance);
+    return matching * 100 >= probe->min_percent * rect.width * rect.height;
+}
+
+
+bool signature_matches(const Signature *signature, const CoordTable *coords, const Frame *frame) {
+    for (int i = 0; i < signature->probe_count; i++) {
+        const SignatureProbe *probe = &signature->probes[i];
+        if (probe_matches(probe, coords, frame) == probe->absent) {
+            return false;
+        }
+    }
+    return signature->probe_count > 0;
+}
+
+
+Recognition recognize(const GameConfig *config, const CoordTable *coords, const Frame *frame) {
+    Recognition result = {STATE_UNKNOWN, 0};
+    for (int i = 0; i < config->state_count; i++) {
+        if (signature_matches(&config->states[i], coords, frame)) {
+            result.matched |= 1u << i;
+            if (result.state == STATE_UNKNOWN) {
+                result.state = i;
+            }
+        }
+    }
+    return result;
+}
+
@@ -0,0 +1,31 @@
+#ifndef RECOGNIZER_H
+#define RECOGNIZER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "config.h"
+#include "coords.h"
+#include "frame.h"
+
+typedef struct {
+    int state;         // First matching state in priority order, or STATE_UNKNOWN
+    uint32_t matched;  // Bit i is set when signature i matched (popups can be stacked)
+} Recognition;
+
+/**
+ * @brief Whether the color of the probe is there (a region probe: in enough of the region's
+ * pixels), regardless of absent
+ */
+bool probe_matches(const SignatureProbe *probe, const CoordTable *coords, const Frame *frame);
+
+/**
+ * @brief Checks whether all probes of a signature match the frame
+ */
+bool signature_matches(const Signature *signature, const CoordTable *coords, const Frame *frame);
+
+/**
+ * @brief Evaluates every signature against one captured frame in a single pass
+ */
+Recognition recognize(const GameConfig *config, const CoordTable *coords, const Frame *frame);
+
+#endif
@@ -0,0 +1,899 @@
+// madvise is not part of C11 or POSIX.1; it must be requested before any system header
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include "input.h"
+#include "recording.h"
+
+#define RECORDING_MAGIC "MREC"
+#define RECORDING_VERSION 2
+
+// Control word of the run-length code: with this bit one value repeats, without it that many values follow
+#define RECORDING_RUN 0x80000000u
+#define RECORDING_COUNT_MASK 0x7FFFFFFFu
+
+typedef enum {
+    RECORD_FRAME = 1,   // RecordedFrame and the code of its pixels
+    RECORD_INPUT,       // Event count and RecordedEvents
+    RECORD_WINDOWS      // Window count and RecordedWindows
+} RecordType;
+
+// The file: RecordingHeader, the records (RecordHeader and payload, both multiples of 4 bytes),
+// a RecordingIndexEntry for every frame and the RecordingFooter
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    int32_t screen_width;
+    int32_t screen_height;
+} RecordingHeader;
+
+typedef struct {
+    uint32_t type;
+    uint32_t size;      // Payload bytes
+    uint64_t time_ms;   // Recorded clock
+} RecordHeader;
+
+typedef struct {
+    int32_t x;
+    int32_t y;
+    int32_t width;
+    int32_t height;
+    uint32_t slot;      // Window rectangle it belongs to
+    uint32_t keyframe;  // Its own number if stored whole, else the keyframe its chain of deltas starts from
+} RecordedFrame;
+
+typedef struct {
+    int32_t type;
+    int32_t x;
+    int32_t y;
+    uint32_t hold_ms;
+} RecordedEvent;
+
+typedef struct {
+    int32_t x;
+    int32_t y;
+    int32_t width;
+    int32_t height;
+    uint64_t id;
+} RecordedWindow;
+
+typedef struct {
+    uint64_t offset;    // Of the frame's record
+    uint64_t time_ms;
+    uint32_t slot;
+    uint32_t keyframe;
+} RecordingIndexEntry;
+
+typedef struct {
+    uint64_t index_offset;
+    uint32_t frame_count;
+    char magic[4];
+} RecordingFooter;
+
+/**
+ * @brief The last frame of one window rectangle, the base of its next delta
+ */
+typedef struct {
+    bool used;
+    int x;
+    int y;
+    int width;
+    int height;
+    uint32_t *pixels;           // Packed rows
+    size_t capacity;
+    uint32_t since_keyframe;    // Deltas stored since its keyframe
+    uint32_t keyframe;
+    uint32_t last_frame;        // For reusing the slot unused the longest
+} RecordingSlot;
+
+
+static bool recording_slot_reserve(RecordingSlot *slot, size_t pixels) {
+    if (pixels <= slot->capacity) {
+        return true;
+    }
+    uint32_t *grown = realloc(slot->pixels, pixels * sizeof(uint32_t));
+    if (grown == NULL) {
+        return false;
+    }
+    slot->pixels = grown;
+    slot->capacity = pixels;
+    return true;
+}
+
+
+/**
+ * @brief Run-length code of the values: runs of one value take two words, anything else
+ * is copied. XOR deltas of a mostly still screen are long runs of zeros.
+ * @param code At least 2 * count + 2 words
+ * @return Words written
+ */
+static size_t recording_encode(const uint32_t *values, size_t count, uint32_t *code) {
+    size_t words = 0, i = 0;
+    while (i < count) {
+        size_t run = 1;
+        while (i + run < count && run < RECORDING_COUNT_MASK && values[i + run] == values[i]) {
+            run++;
+        }
+        if (run >= 2) {
+            code[words++] = RECORDING_RUN | (uint32_t)run;
+            code[words++] = values[i];
+            i += run;
+            continue;
+        }
+
+        // Literals up to the next pair of equal values
+        size_t start = i++;
+        while (i < count && i - start < RECORDING_COUNT_MASK && !(i + 1 < count && values[i] == values[i + 1])) {
+            i++;
+        }
+        code[words++] = (uint32_t)(i - start);
+        memcpy(code + words, values + start, (i - start) * sizeof(uint32_t));
+        words += i - start;
+    }
+    return words;
+}
+
+
+/**
+ * @brief Decodes into the pixels: stores the values of a keyframe, XORs those of a delta
+ * @return false if the code does not describe exactly count pixels
+ */
+static bool recording_decode(const uint32_t *code, size_t words, uint32_t *pixels, size_t count, bool delta) {
+    size_t w = 0, i = 0;
+    while (w < words) {
+        uint32_t control = code[w++];
+        size_t n = control & RECORDING_COUNT_MASK;
+        if (n > count - i) {
+            return false;
+        }
+        if (control & RECORDING_RUN) {
+            if (w >= words) {
+                return false;
+            }
+            uint32_t value = code[w++];
+            if (!delta) {
+                for (size_t k = 0; k < n; k++) {
+                    pixels[i + k] = value;
+                }
+            }
+            // A run of zeros is an unchanged stretch, nothing to do
+            else if (value != 0) {
+                for (size_t k = 0; k < n; k++) {
+                    pixels[i + k] ^= value;
+                }
+            }
+        }
+        else {
+            if (n > words - w) {
+                return false;
+            }
+            if (!delta) {
+                memcpy(pixels + i, code + w, n * sizeof(uint32_t));
+            }
+            else {
+                for (size_t k = 0; k < n; k++) {
+                    pixels[i + k] ^= code[w + k];
+                }
+            }
+            w += n;
+        }
+        i += n;
+    }
+    return i == count;
+}
+
+
+// -------------------------------------------------------------------------------------------------
+// Recorder
+
+typedef struct {
+    Backend *inner;
+    FILE *file;
+    char *path;
+    uint64_t offset;            // Bytes written
+    RecordingSlot slots[RECORDING_SLOTS];
+    uint32_t *values;           // The delta being encoded
+    size_t values_capacity;
+    uint32_t *code;
+    size_t code_capacity;
+    RecordingIndexEntry *index;  // Grows by 1024 entries
+    RecordingStats stats;
+    bool failed;                // A write failed, the recording is incomplete
+} RecorderContext;
+
+
+static void recorder_write(RecorderContext *ctx, const void *data, size_t size) {
+    if (!ctx->failed && fwrite(data, 1, size, ctx->file) != size) {
+        printf("\nError: Failed to write the recording %s.\n", ctx->path);
+        ctx->failed = true;
+    }
+    ctx->offset += size;
+}
+
+
+static void recorder_record(RecorderContext *ctx, RecordType type, uint64_t time_ms,
+                            const void *head, size_t head_size, const void *body, size_t body_size) {
+    RecordHeader header = {(uint32_t)type, (uint32_t)(head_size + body_size), time_ms};
+    recorder_write(ctx, &header, sizeof(header));
+    recorder_write(ctx, head, head_size);
+    recorder_write(ctx, body, body_size);
+}
+
+
+static bool recorder_reserve(uint32_t **buffer, size_t *capacity, size_t words) {
+    if (words <= *capacity) {
+        return true;
+    }
+    uint32_t *grown = realloc(*buffer, words * sizeof(uint32_t));
+    if (grown == NULL) {
+        return false;
+    }
+    *buffer = grown;
+    *capacity = words;
+    return true;
+}
+
+
+/**
+ * @brief The slot of the frame's rectangle, else a free one, else the one unused the longest
+ */
+static RecordingSlot *recorder_slot(RecorderContext *ctx, const Frame *frame, uint32_t *index) {
+    uint32_t chosen = RECORDING_SLOTS;
+    for (uint32_t i = 0; i < RECORDING_SLOTS; i++) {
+        RecordingSlot *slot = &ctx->slots[i];
+        if (slot->used && slot->x == frame->x && slot->y == frame->y && slot->width == frame->width && slot->height == frame->height) {
+            *index = i;
+            return slot;
+        }
+        if (chosen == RECORDING_SLOTS || (ctx->slots[chosen].used &&
+                                          (!slot->used || slot->last_frame < ctx->slots[chosen].last_frame))) {
+            chosen = i;
+        }
+    }
+    // A new rectangle starts with a keyframe
+    ctx->slots[chosen].used = false;
+    *index = chosen;
+    return &ctx->slots[chosen];
+}
+
+
+static void recorder_frame(RecorderContext *ctx, const Frame *frame, uint64_t time_ms) {
+    uint32_t number = ctx->stats.frames;
+    uint32_t slot_index;
+    RecordingSlot *slot = recorder_slot(ctx, frame, &slot_index);
+    size_t count = (size_t)frame->width * (size_t)frame->height;
+    bool keyframe = !slot->used || slot->since_keyframe + 1 >= RECORDING_KEYFRAME_INTERVAL;
+    if (!recording_slot_reserve(slot, count) || !recorder_reserve(&ctx->code, &ctx->code_capacity, 2 * count + 2) ||
+        (!keyframe && !recorder_reserve(&ctx->values, &ctx->values_capacity, count))) {
+        printf("\nError: Failed to allocate the recording buffers.\n");
+        ctx->failed = true;
+        return;
+    }
+    if (number % 1024 == 0) {
+        RecordingIndexEntry *index = realloc(ctx->index, (number + 1024) * sizeof(RecordingIndexEntry));
+        if (index == NULL) {
+            ctx->failed = true;
+            return;
+        }
+        ctx->index = index;
+    }
+
+    // A keyframe is the frame itself; a delta is the XOR with the rectangle's previous frame,
+    // which this frame then replaces
+    const uint32_t *values = slot->pixels;
+    for (int row = 0; row < frame->height; row++) {
+        const uint32_t *source = frame->pixels + (size_t)row * frame->stride;
+        uint32_t *base = slot->pixels + (size_t)row * frame->width;
+        if (keyframe) {
+            memcpy(base, source, (size_t)frame->width * sizeof(uint32_t));
+            continue;
+        }
+        uint32_t *delta = ctx->values + (size_t)row * frame->width;
+        for (int x = 0; x < frame->width; x++) {
+            delta[x] = source[x] ^ base[x];
+            base[x] = source[x];
+        }
+        values = ctx->values;
+    }
+    if (keyframe) {
+        slot->used = true;
+        slot->x = frame->x;
+        slot->y = frame->y;
+        slot->width = frame->width;
+        slot->height = frame->height;
+        slot->keyframe = number;
+        slot->since_keyframe = 0;
+        ctx->stats.keyframes++;
+    }
+    else {
+        slot->since_keyframe++;
+    }
+    slot->last_frame = number;
+    size_t words = recording_encode(values, count, ctx->code);
+
+    RecordingIndexEntry entry = {ctx->offset, time_ms, slot_index, slot->keyframe};
+    ctx->index[number] = entry;
+    RecordedFrame head = {frame->x, frame->y, frame->width, frame->height, slot_index, slot->keyframe};
+    recorder_record(ctx, RECORD_FRAME, time_ms, &head, sizeof(head), ctx->code, words * sizeof(uint32_t));
+
+    ctx->stats.frames++;
+    ctx->stats.raw_bytes += count * sizeof(uint32_t);
+    if (number == 0) {
+        ctx->stats.first_ms = time_ms;
+    }
+    ctx->stats.last_ms = time_ms;
+}
+
+
+static bool recorder_capture(Backend *self, int x, int y, int width, int height, Frame *frame) {
+    RecorderContext *ctx = self->ctx;
+    if (!ctx->inner->capture(ctx->inner, x, y, width, height, frame)) {
+        return false;
+    }
+    recorder_frame(ctx, frame, frame->time_ms);
+    return true;
+}
+
+
+static void recorder_send(Backend *self, const InputEvent *events, int count) {
+    RecorderContext *ctx = self->ctx;
+    uint64_t now = ctx->inner->now_ms(ctx->inner);
+    ctx->inner->send(ctx->inner, events, count);
+
+    RecordedEvent recorded[INPUT_SEQUENCE_MAX];
+    uint32_t n = count < INPUT_SEQUENCE_MAX ? (uint32_t)count : INPUT_SEQUENCE_MAX;
+    for (uint32_t i = 0; i < n; i++) {
+        RecordedEvent event = {(int32_t)events[i].type, events[i].x, events[i].y, events[i].hold_ms};
+        recorded[i] = event;
+    }
+    recorder_record(ctx, RECORD_INPUT, now, &n, sizeof(n), recorded, n * sizeof(RecordedEvent));
+    ctx->stats.inputs++;
+}
+
+
+static int recorder_windows(Backend *self, GameArea *windows, int max) {
+    RecorderContext *ctx = self->ctx;
+    int count = ctx->inner->windows(ctx->inner, windows, max);
+
+    RecordedWindow recorded[RECORDING_SLOTS];
+    uint32_t n = 0;
+    for (int i = 0; i < count && n < RECORDING_SLOTS; i++) {
+        RecordedWindow window = {windows[i].x, windows[i].y, windows[i].width, windows[i].height, (uint64_t)windows[i].id};
+        recorded[n++] = window;
+    }
+    recorder_record(ctx, RECORD_WINDOWS, ctx->inner->now_ms(ctx->inner), &n, sizeof(n), recorded, n * sizeof(RecordedWindow));
+    return count;
+}
+
+
+static bool recorder_focus(Backend *self, const GameArea *window) {
+    RecorderContext *ctx = self->ctx;
+    return ctx->inner->focus(ctx->inner, window);
+}
+
+
+static ScreenMetrics recorder_metrics(Backend *self) {
+    RecorderContext *ctx = self->ctx;
+    return ctx->inner->metrics(ctx->inner);
+}
+
+
+static uint64_t recorder_now_ms(Backend *self) {
+    RecorderContext *ctx = self->ctx;
+    return ctx->inner->now_ms(ctx->inner);
+}
+
+
+static void recorder_sleep_ms(Backend *self, unsigned ms) {
+    RecorderContext *ctx = self->ctx;
+    ctx->inner->sleep_ms(ctx->inner, ms);
+}
+
+
+static void recorder_destroy(Backend *self) {
+    RecorderContext *ctx = self->ctx;
+    // The index and the footer complete the file
+    RecordingFooter footer = {ctx->offset, ctx->stats.frames, {0}};
+    memcpy(footer.magic, RECORDING_MAGIC, sizeof(footer.magic));
+    if (ctx->stats.frames > 0) {
+        recorder_write(ctx, ctx->index, ctx->stats.frames * sizeof(RecordingIndexEntry));
+    }
+    recorder_write(ctx, &footer, sizeof(footer));
+    if (fclose(ctx->file) != 0 && !ctx->failed) {
+        printf("\nError: Failed to write the recording %s.\n", ctx->path);
+    }
+    for (int i = 0; i < RECORDING_SLOTS; i++) {
+        free(ctx->slots[i].pixels);
+    }
+    free(ctx->values);
+    free(ctx->code);
+    free(ctx->index);
+    free(ctx->path);
+    free(ctx);
+    free(self);
+}
+
+
+Backend *recorder_create(Backend *inner, const char *path) {
+    Backend *backend = calloc(1, sizeof(Backend));
+    RecorderContext *ctx = calloc(1, sizeof(RecorderContext));
+    char *path_copy = malloc(strlen(path) + 1);
+    if (backend == NULL || ctx == NULL || path_copy == NULL) {
+        free(backend);
+        free(ctx);
+        free(path_copy);
+        return NULL;
+    }
+    strcpy(path_copy, path);
+    ctx->path = path_copy;
+    ctx->inner = inner;
+    ctx->file = fopen(path, "wb");
+    if (ctx->file == NULL) {
+        printf("\nError: Failed to create the recording %s.\n", path);
+        free(path_copy);
+        free(ctx);
+        free(backend);
+        return NULL;
+    }
+
+    ScreenMetrics screen = inner->metrics(inner);
+    RecordingHeader header = {{0}, RECORDING_VERSION, screen.width, screen.height};
+    memcpy(header.magic, RECORDING_MAGIC, sizeof(header.magic));
+    recorder_write(ctx, &header, sizeof(header));
+
+    backend->name = "recorder";
+    backend->ctx = ctx;
+    backend->capture = recorder_capture;
+    backend->send = recorder_send;
+    backend->metrics = recorder_metrics;
+    backend->windows = recorder_windows;
+    backend->focus = recorder_focus;
+    backend->now_ms = recorder_now_ms;
+    backend->sleep_ms = recorder_sleep_ms;
+    backend->destroy = recorder_destroy;
+    return backend;
+}
+
+
+RecordingStats recorder_stats(Backend *recorder) {
+    RecorderContext *ctx = recorder->ctx;
+    RecordingStats stats = ctx->stats;
+    stats.bytes = ctx->offset;
+    return stats;
+}
+
+
+// -------------------------------------------------------------------------------------------------
+// Replay
+
+typedef struct {
+    const uint8_t *data;        // The mapped file
+    size_t size;
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#endif
+    ScreenMetrics screen;
+    RecordingIndexEntry *index;
+    size_t end;                 // Where the records end and the index starts
+    size_t position;            // Next record
+    uint32_t next_frame;
+    RecordingSlot slots[RECORDING_SLOTS];
+    GameArea windows[RECORDING_SLOTS];  // Last recorded window list
+    int window_count;
+    uint64_t now;
+    RecordingStats stats;
+} ReplayContext;
+
+
+/**
+ * @brief Reads the header of the record at position
+ * @return false at the end of the records or if the record does not fit before it
+ */
+static bool replay_record(const ReplayContext *ctx, size_t position, RecordHeader *header) {
+    if (position + sizeof(RecordHeader) > ctx->end) {
+        return false;
+    }
+    memcpy(header, ctx->data + position, sizeof(RecordHeader));
+    return header->size <= ctx->end - position - sizeof(RecordHeader) && header->size % 4 == 0;
+}
+
+
+/**
+ * @brief Decodes frame number of the record at position into its slot
+ * @return NULL if the record is not a valid frame or its delta has no base
+ */
+static RecordingSlot *replay_decode(ReplayContext *ctx, size_t position, uint32_t number) {
+    RecordHeader header;
+    RecordedFrame head;
+    if (!replay_record(ctx, position, &header) || header.type != RECORD_FRAME || header.size < sizeof(RecordedFrame)) {
+        return NULL;
+    }
+    memcpy(&head, ctx->data + position + sizeof(RecordHeader), sizeof(head));
+    if (head.slot >= RECORDING_SLOTS || head.width <= 0 || head.height <= 0 || head.keyframe > number) {
+        return NULL;
+    }
+
+    RecordingSlot *slot = &ctx->slots[head.slot];
+    bool keyframe = head.keyframe == number;
+    size_t count = (size_t)head.width * (size_t)head.height;
+    if (!keyframe && (!slot->used || slot->keyframe != head.keyframe || slot->width != head.width || slot->height != head.height)) {
+        return NULL;
+    }
+    if (!recording_slot_reserve(slot, count)) {
+        return NULL;
+    }
+    // Records start at multiples of 4 bytes in the page-aligned mapping, so the code is word-aligned
+    const uint32_t *code = (const uint32_t *)(ctx->data + position + sizeof(RecordHeader) + sizeof(RecordedFrame));
+    size_t words = (header.size - sizeof(RecordedFrame)) / sizeof(uint32_t);
+    if (!recording_decode(code, words, slot->pixels, count, !keyframe)) {
+        slot->used = false;
+        return NULL;
+    }
+    slot->used = true;
+    slot->x = head.x;
+    slot->y = head.y;
+    slot->width = head.width;
+    slot->height = head.height;
+    slot->keyframe = head.keyframe;
+    slot->last_frame = number;
+    return slot;
+}
+
+
+static bool replay_capture(Backend *self, int x, int y, int width, int height, Frame *frame) {
+    ReplayContext *ctx = self->ctx;
+    RecordHeader header;
+    // Input and window lists before the next frame were not asked for this time
+    while (replay_record(ctx, ctx->position, &header) && header.type != RECORD_FRAME) {
+        ctx->position += sizeof(RecordHeader) + header.size;
+        ctx->stats.diverged++;
+    }
+    if (ctx->next_frame >= ctx->stats.frames || ctx->position != ctx->index[ctx->next_frame].offset) {
+        return false;
+    }
+
+    RecordingSlot *slot = replay_decode(ctx, ctx->position, ctx->next_frame);
+    ctx->position += sizeof(RecordHeader) + header.size;
+    ctx->next_frame++;
+    if (slot == NULL) {
+        printf("\nError: Frame %u of the recording is damaged.\n", ctx->next_frame - 1);
+        return false;
+    }
+    if (slot->x != x || slot->y != y || slot->width != width || slot->height != height) {
+        ctx->stats.diverged++;
+    }
+    if (!frame_reserve(frame, slot->width, slot->height)) {
+        return false;
+    }
+    for (int row = 0; row < slot->height; row++) {
+        memcpy(frame->pixels + (size_t)row * frame->stride, slot->pixels + (size_t)row * slot->width,
+               (size_t)slot->width * sizeof(uint32_t));
+    }
+    frame->x = slot->x;
+    frame->y = slot->y;
+    frame->sequence++;
+    frame->time_ms = header.time_ms;
+    ctx->now = header.time_ms;
+    ctx->stats.replayed++;
+    return true;
+}
+
+
+static void replay_send(Backend *self, const InputEvent *events, int count) {
+    ReplayContext *ctx = self->ctx;
+    // The pauses between the events take time, as they did when recording
+    for (int i = 0; i < count; i++) {
+        ctx->now += events[i].hold_ms;
+    }
+
+    RecordHeader header;
+    uint32_t recorded;
+    if (!replay_record(ctx, ctx->position, &header) || header.type != RECORD_INPUT || header.size < sizeof(recorded)) {
+        ctx->stats.diverged++;
+        return;
+    }
+    const uint8_t *payload = ctx->data + ctx->position + sizeof(RecordHeader);
+    memcpy(&recorded, payload, sizeof(recorded));
+    bool same = recorded == (uint32_t)count && header.size == sizeof(recorded) + recorded * sizeof(RecordedEvent);
+    for (uint32_t i = 0; i < recorded && same; i++) {
+        RecordedEvent event;
+        memcpy(&event, payload + sizeof(recorded) + i * sizeof(RecordedEvent), sizeof(event));
+        same = event.type == (int32_t)events[i].type && event.x == events[i].x && event.y == events[i].y &&
+               event.hold_ms == events[i].hold_ms;
+    }
+    ctx->position += sizeof(RecordHeader) + header.size;
+    if (same) {
+        ctx->stats.matched++;
+    }
+    else {
+        ctx->stats.diverged++;
+    }
+}
+
+
+static ScreenMetrics replay_metrics(Backend *self) {
+    ReplayContext *ctx = self->ctx;
+    return ctx->screen;
+}
+
+
+static int replay_windows(Backend *self, GameArea *windows, int max) {
+    ReplayContext *ctx = self->ctx;
+    RecordHeader header;
+    uint32_t recorded;
+    if (replay_record(ctx, ctx->position, &header) && header.type == RECORD_WINDOWS && header.size >= sizeof(recorded)) {
+        const uint8_t *payload = ctx->data + ctx->position + sizeof(RecordHeader);
+        memcpy(&recorded, payload, sizeof(recorded));
+        ctx->window_count = 0;
+        for (uint32_t i = 0; i < recorded && i < RECORDING_SLOTS &&
+                             sizeof(recorded) + (i + 1) * sizeof(RecordedWindow) <= header.size; i++) {
+            RecordedWindow window;
+            memcpy(&window, payload + sizeof(recorded) + i * sizeof(RecordedWindow), sizeof(window));
+            GameArea area = {window.x, window.y, window.width, window.height, (uintptr_t)window.id};
+            ctx->windows[ctx->window_count++] = area;
+        }
+        ctx->position += sizeof(RecordHeader) + header.size;
+    }
+    else {
+        // Asked at another time than when recording: the last list still holds
+        ctx->stats.diverged++;
+    }
+
+    int count = ctx->window_count < max ? ctx->window_count : max;
+    memcpy(windows, ctx->windows, (size_t)count * sizeof(GameArea));
+    return count;
+}
+
+
+static uint64_t replay_now_ms(Backend *self) {
+    ReplayContext *ctx = self->ctx;
+    return ctx->now;
+}
+
+
+static void replay_sleep_ms(Backend *self, unsigned ms) {
+    ReplayContext *ctx = self->ctx;
+    ctx->now += ms;
+}
+
+
+static void replay_unmap(ReplayContext *ctx) {
+#ifdef _WIN32
+    if (ctx->data != NULL) {
+        UnmapViewOfFile(ctx->data);
+    }
+    if (ctx->mapping != NULL) {
+        CloseHandle(ctx->mapping);
+    }
+    if (ctx->file != NULL && ctx->file != INVALID_HANDLE_VALUE) {
+        CloseHandle(ctx->file);
+    }
+#else
+    if (ctx->data != NULL) {
+        munmap((void *)ctx->data, ctx->size);
+    }
+#endif
+    ctx->data = NULL;
+}
+
+
+static void replay_free(ReplayContext *ctx) {
+    replay_unmap(ctx);
+    for (int i = 0; i < RECORDING_SLOTS; i++) {
+        free(ctx->slots[i].pixels);
+    }
+    free(ctx->index);
+    free(ctx);
+}
+
+
+static void replay_destroy(Backend *self) {
+    replay_free(self->ctx);
+    free(self);
+}
+
+
+static bool replay_map(ReplayContext *ctx, const char *path) {
+#ifdef _WIN32
+    LARGE_INTEGER size;
+    ctx->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (ctx->file == INVALID_HANDLE_VALUE || !GetFileSizeEx(ctx->file, &size) || size.QuadPart <= 0) {
+        return false;
+    }
+    ctx->size = (size_t)size.QuadPart;
+    ctx->mapping = CreateFileMappingA(ctx->file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (ctx->mapping == NULL) {
+        return false;
+    }
+    ctx->data = MapViewOfFile(ctx->mapping, FILE_MAP_READ, 0, 0, 0);
+    return ctx->data != NULL;
+#else
+    int file = open(path, O_RDONLY);
+    struct stat status;
+    if (file < 0 || fstat(file, &status) != 0 || status.st_size <= 0) {
+        if (file >= 0) {
+            close(file);
+        }
+        return false;
+    }
+    ctx->size = (size_t)status.st_size;
+    void *data = mmap(NULL, ctx->size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+    // The frames are read front to back
+    madvise(data, ctx->size, MADV_SEQUENTIAL);
+    ctx->data = data;
+    return true;
+#endif
+}
+
+
+/**
+ * @brief Checks the header, the footer and the index, and walks the records once for the totals.
+ * A recording without its footer (the bot was killed while recording) is read up to its last
+ * complete record, with the index rebuilt on the way.
+ */
+static bool replay_open(ReplayContext *ctx) {
+    RecordingHeader header;
+    RecordingFooter footer;
+    if (ctx->size < sizeof(header)) {
+        return false;
+    }
+    memcpy(&header, ctx->data, sizeof(header));
+    if (memcmp(header.magic, RECORDING_MAGIC, 4) != 0 || header.version != RECORDING_VERSION) {
+        return false;
+    }
+    bool complete = false;
+    if (ctx->size >= sizeof(header) + sizeof(footer)) {
+        memcpy(&footer, ctx->data + ctx->size - sizeof(footer), sizeof(footer));
+        complete = memcmp(footer.magic, RECORDING_MAGIC, 4) == 0 && footer.index_offset >= sizeof(header) &&
+                   footer.index_offset + (uint64_t)footer.frame_count * sizeof(RecordingIndexEntry) + sizeof(footer) == ctx->size;
+    }
+    ctx->screen.width = header.screen_width;
+    ctx->screen.height = header.screen_height;
+    ctx->end = complete ? (size_t)footer.index_offset : ctx->size;
+    ctx->position = sizeof(header);
+    ctx->stats.bytes = ctx->size;
+
+    size_t capacity = complete ? (size_t)footer.frame_count + 1 : 1024;
+    ctx->index = malloc(capacity * sizeof(RecordingIndexEntry));
+    if (ctx->index == NULL) {
+        return false;
+    }
+    if (complete) {
+        memcpy(ctx->index, ctx->data + ctx->end, (size_t)footer.frame_count * sizeof(RecordingIndexEntry));
+    }
+
+    uint32_t frame = 0;
+    RecordHeader record;
+    size_t position = ctx->position;
+    while (replay_record(ctx, position, &record)) {
+        if (record.type == RECORD_FRAME) {
+            RecordedFrame head;
+            if (record.size < sizeof(head)) {
+                return false;
+            }
+            memcpy(&head, ctx->data + position + sizeof(RecordHeader), sizeof(head));
+            if (complete && (frame >= footer.frame_count || ctx->index[frame].offset != position)) {
+                return false;
+            }
+            if (!complete) {
+                if (frame + 1 >= capacity) {
+                    RecordingIndexEntry *index = realloc(ctx->index, 2 * capacity * sizeof(RecordingIndexEntry));
+                    if (index == NULL) {
+                        return false;
+                    }
+                    ctx->index = index;
+                    capacity *= 2;
+                }
+                RecordingIndexEntry entry = {position, record.time_ms, head.slot, head.keyframe};
+                ctx->index[frame] = entry;
+            }
+            ctx->stats.keyframes += head.keyframe == frame;
+            ctx->stats.raw_bytes += (uint64_t)head.width * (uint64_t)head.height * sizeof(uint32_t);
+            frame++;
+        }
+        else if (record.type == RECORD_INPUT) {
+            ctx->stats.inputs++;
+        }
+        if (position == ctx->position) {
+            ctx->now = record.time_ms;
+        }
+        position += sizeof(RecordHeader) + record.size;
+    }
+    if (complete && (position != ctx->end || frame != footer.frame_count)) {
+        return false;
+    }
+    // The records of an incomplete recording end with the last whole one
+    ctx->end = position;
+    ctx->stats.frames = frame;
+    if (frame > 0) {
+        ctx->stats.first_ms = ctx->index[0].time_ms;
+        ctx->stats.last_ms = ctx->index[frame - 1].time_ms;
+    }
+    return true;
+}
+
+
+Backend *replay_create(const char *path) {
+    Backend *backend = calloc(1, sizeof(Backend));
+    ReplayContext *ctx = calloc(1, sizeof(ReplayContext));
+    if (backend == NULL || ctx == NULL) {
+        free(backend);
+        free(ctx);
+        return NULL;
+    }
+    if (!replay_map(ctx, path)) {
+        printf("\nError: Failed to map the recording %s.\n", path);
+        replay_free(ctx);
+        free(backend);
+        return NULL;
+    }
+    if (!replay_open(ctx)) {
+        printf("\nError: %s is not a recording.\n", path);
+        replay_free(ctx);
+        free(backend);
+        return NULL;
+    }
+
+    backend->name = "replay";
+    backend->ctx = ctx;
+    backend->capture = replay_capture;
+    backend->send = replay_send;
+    backend->metrics = replay_metrics;
+    backend->windows = replay_windows;
+    // The focus follows the recorded input by itself
+    backend->focus = backend_focus_screen;
+    backend->now_ms = replay_now_ms;
+    backend->sleep_ms = replay_sleep_ms;
+    backend->destroy = replay_destroy;
+    return backend;
+}
+
+
+RecordingStats replay_stats(Backend *replay) {
+    ReplayContext *ctx = replay->ctx;
+    return ctx->stats;
+}
+
+
+bool replay_seek(Backend *replay, uint32_t frame) {
+    ReplayContext *ctx = replay->ctx;
+    if (frame >= ctx->stats.frames) {
+        return false;
+    }
+    for (int i = 0; i < RECORDING_SLOTS; i++) {
+        ctx->slots[i].used = false;
+    }
+
+    // Every rectangle as of its last frame before this one, decoded from its keyframe on
+    bool found[RECORDING_SLOTS] = {false};
+    for (uint32_t last = frame; last-- > 0;) {
+        const RecordingIndexEntry *entry = &ctx->index[last];
+        if (entry->slot >= RECORDING_SLOTS || found[entry->slot]) {
+            continue;
+        }
+        found[entry->slot] = true;
+        for (uint32_t k = entry->keyframe; k <= last; k++) {
+            if (ctx->index[k].slot == entry->slot && replay_decode(ctx, (size_t)ctx->index[k].offset, k) == NULL) {
+                return false;
+            }
+        }
+    }
+    ctx->position = (size_t)ctx->index[frame].offset;
+    ctx->next_frame = frame;
+    ctx->now = ctx->index[frame].time_ms;
+    return true;
+}
@@ -0,0 +1,57 @@
+#ifndef RECORDING_H
+#define RECORDING_H
+
+#include <stdint.h>
+#include "backend.h"
+
+// Every Nth frame of a window rectangle is stored whole, the others as changes to the previous one
+#define RECORDING_KEYFRAME_INTERVAL 100
+
+// Window rectangles a recording follows at once (one per game window)
+#define RECORDING_SLOTS 16
+
+typedef struct {
+    uint32_t frames;      // Captures recorded
+    uint32_t keyframes;   // Of them stored whole
+    uint32_t inputs;      // Input sequences recorded
+    uint64_t bytes;       // Size of the recording file
+    uint64_t raw_bytes;   // Size of the frames uncompressed
+    uint64_t first_ms;    // Recorded clock of the first and the last capture
+    uint64_t last_ms;
+    // Replay only
+    uint32_t replayed;    // Frames delivered
+    uint32_t matched;     // Input sequences sent exactly as recorded
+    uint32_t diverged;    // Calls that did not follow the recording: other input, other rectangle, skipped records
+} RecordingStats;
+
+/**
+ * @brief Records a session: wraps a backend, passes every call on to it and streams its
+ * captures (keyframes and XOR deltas, run-length encoded), the input sent and the window
+ * lists into a file with a frame index at the end. Destroying the recorder completes the
+ * file; the wrapped backend stays and is destroyed by its owner. Not for capture threads.
+ * @return NULL if the file could not be created (the error is printed)
+ */
+Backend *recorder_create(Backend *inner, const char *path);
+
+RecordingStats recorder_stats(Backend *recorder);
+
+/**
+ * @brief Plays a recording back as a backend. The file is memory-mapped and every capture
+ * returns the next recorded frame, whatever it is asked for; the clock follows the recorded
+ * one, sleeping only moves it. Input is compared with the recorded input, so a bot that
+ * recognizes the frames as it did while recording replays the session exactly. A recording
+ * that was never completed plays up to its last whole record.
+ * @return NULL if the file can't be mapped or is not a recording (the error is printed)
+ */
+Backend *replay_create(const char *path);
+
+RecordingStats replay_stats(Backend *replay);
+
+/**
+ * @brief Makes the next capture return frame n of the recording, decoding the window
+ * rectangles from their keyframes through the frame index
+ * @return false if the recording has no frame n
+ */
+bool replay_seek(Backend *replay, uint32_t frame);
+
+#endif
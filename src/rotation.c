@@ -0,0 +1,113 @@
+#include "rotation.h"
+
+
+void rotation_init(Rotation *rotation, const GameMode *mode) {
+    Rotation empty = {0};
+    *rotation = empty;
+    rotation->count = mode->spawn_count;
+    for (int i = 0; i < rotation->count; i++) {
+        RotationTarget *target = &rotation->targets[i];
+        target->target = mode->spawns[i].target;
+        target->hint_ms = mode->spawns[i].cooldown_ms;
+        target->shortest_free = ROTATION_UNKNOWN;
+    }
+    rotation->engaged = -1;
+    rotation->fighting = -1;
+    rotation->fight_state = STATE_UNKNOWN;
+}
+
+
+uint32_t rotation_cooldown(const RotationTarget *target) {
+    if (target->shortest_free == ROTATION_UNKNOWN) {
+        // Found on cooldown and never free since: at least twice as long as it was seen busy
+        if (target->longest_busy == 0) {
+            return target->hint_ms;
+        }
+        uint32_t longer = 2 * target->longest_busy + ROTATION_PRECISION_MS;
+        return longer > target->hint_ms ? longer : target->hint_ms;
+    }
+    if (target->shortest_free - target->longest_busy <= ROTATION_PRECISION_MS) {
+        return target->shortest_free;
+    }
+    return target->longest_busy + (target->shortest_free - target->longest_busy) / 2;
+}
+
+
+int rotation_next(const Rotation *rotation, uint64_t now_ms, uint64_t *ready_ms) {
+    int best = -1;
+    uint64_t best_ready = 0;
+    for (int i = 0; i < rotation->count; i++) {
+        const RotationTarget *target = &rotation->targets[i];
+        uint64_t ready = target->released ? target->released_ms + rotation_cooldown(target) : 0;
+        if (ready < now_ms) {
+            ready = now_ms;
+        }
+        if (best < 0 || ready < best_ready ||
+            (ready == best_ready && target->released_ms < rotation->targets[best].released_ms)) {
+            best = i;
+            best_ready = ready;
+        }
+    }
+    *ready_ms = best_ready;
+    return best;
+}
+
+
+void rotation_engage(Rotation *rotation, int target, uint64_t now_ms) {
+    rotation->engaged = target;
+    rotation->engaged_ms = now_ms;
+}
+
+
+void rotation_result(Rotation *rotation, bool started, int state) {
+    if (rotation->engaged < 0) {
+        return;
+    }
+    RotationTarget *target = &rotation->targets[rotation->engaged];
+    uint64_t since = target->released ? rotation->engaged_ms - target->released_ms : 0;
+    uint32_t elapsed = since < ROTATION_UNKNOWN ? (uint32_t)since : ROTATION_UNKNOWN - 1;
+
+    if (started) {
+        target->fights++;
+        if (target->released) {
+            // Free earlier than it was once seen busy: the cooldown got shorter, start over
+            if (elapsed <= target->longest_busy) {
+                target->longest_busy = 0;
+            }
+            if (elapsed < target->shortest_free) {
+                target->shortest_free = elapsed;
+            }
+        }
+        rotation->fighting = rotation->engaged;
+        rotation->fight_state = state;
+    }
+    else {
+        target->busy_clicks++;
+        if (target->released) {
+            // Busy later than it was once seen free: the cooldown got longer, start over
+            if (elapsed >= target->shortest_free) {
+                target->shortest_free = ROTATION_UNKNOWN;
+            }
+            if (elapsed > target->longest_busy) {
+                target->longest_busy = elapsed;
+            }
+        }
+        else {
+            // On cooldown from a fight the bot did not see: count from the click
+            target->released = true;
+            target->released_ms = rotation->engaged_ms;
+        }
+    }
+    rotation->engaged = -1;
+}
+
+
+void rotation_update(Rotation *rotation, int state, uint64_t now_ms) {
+    if (rotation->fighting < 0 || state == rotation->fight_state || state == STATE_UNKNOWN) {
+        return;
+    }
+    RotationTarget *target = &rotation->targets[rotation->fighting];
+    target->released = true;
+    target->released_ms = now_ms;
+    rotation->fighting = -1;
+}
@@ -0,0 +1,75 @@
+#ifndef ROTATION_H
+#define ROTATION_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "config.h"
+
+// The learned cooldown stops being narrowed down once it is known this precisely (ms)
+#define ROTATION_PRECISION_MS 1000
+
+// Nothing known about a bound yet
+#define ROTATION_UNKNOWN UINT32_MAX
+
+/**
+ * @brief What is known about one spawn object. Its cooldown runs from the end of a fight
+ * (the first screen after the battle) and is learned from the clicks: a click that started
+ * a fight proves the cooldown was over, one that did not proves it was still running.
+ */
+typedef struct {
+    CoordId target;
+    uint32_t hint_ms;       // Cooldown from the data file, used until a click tells otherwise
+    bool released;          // A fight on it ended (or a click found it on cooldown) at released_ms
+    uint64_t released_ms;
+    uint32_t longest_busy;  // Longest time after the release a click found it on cooldown, 0 for none
+    uint32_t shortest_free; // Shortest time after the release a click started a fight, or ROTATION_UNKNOWN
+    int fights;
+    int busy_clicks;        // Clicks that found it on cooldown
+} RotationTarget;
+
+/**
+ * @brief Spawn objects of one game client. Every engagement goes to the object that will
+ * be ready soonest, so the bot waits only when every object is on cooldown.
+ */
+typedef struct {
+    RotationTarget targets[MAX_SPAWNS];
+    int count;
+    int engaged;        // Target of the click waiting for its result, -1 for none
+    uint64_t engaged_ms;
+    int fighting;       // Target whose fight is on, -1 for none
+    int fight_state;    // Screen its fight started with; leaving it ends the fight
+} Rotation;
+
+void rotation_init(Rotation *rotation, const GameMode *mode);
+
+/**
+ * @brief The cooldown the target is assumed to have now: the configured guess while nothing
+ * contradicts it, then halfway between what the clicks proved until that is precise enough
+ */
+uint32_t rotation_cooldown(const RotationTarget *target);
+
+/**
+ * @brief Picks the target that will be ready soonest (the least recently released on a tie)
+ * @param ready_ms Set to when it will be ready, at most now_ms if it is ready already
+ * @return index of the target, -1 if there are none
+ */
+int rotation_next(const Rotation *rotation, uint64_t now_ms, uint64_t *ready_ms);
+
+/**
+ * @brief A click on the target was sent
+ */
+void rotation_engage(Rotation *rotation, int target, uint64_t now_ms);
+
+/**
+ * @brief Result of the last engagement: a fight started with the given screen, or the
+ * screen did not change (the object was still on cooldown)
+ */
+void rotation_result(Rotation *rotation, bool started, int state);
+
+/**
+ * @brief Follows the screens: leaving the screen the fight started with ends the fight
+ * and starts the cooldown of its object
+ */
+void rotation_update(Rotation *rotation, int state, uint64_t now_ms);
+
+#endif
@@ -0,0 +1,294 @@
+#include <stdio.h>
+#include <string.h>
+#include "scheduler.h"
+#include "wait.h"
+
+
+/**
+ * @brief Follows moved and resized windows. Every instance keeps the window with its identity,
+ * wherever the list puts it (front to back changes with every click). A window that closed
+ * leaves its instance to one that opened since, like the window of a restarted client; with
+ * none, the instance keeps capturing the old rectangle.
+ */
+static void scheduler_refresh_windows(Scheduler *scheduler, uint64_t now) {
+    GameArea windows[SCHEDULER_MAX_INSTANCES];
+    int count = scheduler->backend->windows(scheduler->backend, windows, SCHEDULER_MAX_INSTANCES);
+    bool taken[SCHEDULER_MAX_INSTANCES] = {false};
+    int matched[SCHEDULER_MAX_INSTANCES];
+    for (int i = 0; i < scheduler->count; i++) {
+        matched[i] = -1;
+        for (int k = 0; k < count; k++) {
+            if (!taken[k] && windows[k].id == scheduler->instances[i].window.id) {
+                matched[i] = k;
+                taken[k] = true;
+                break;
+            }
+        }
+    }
+    for (int i = 0; i < scheduler->count; i++) {
+        for (int k = 0; k < count && matched[i] < 0; k++) {
+            if (!taken[k]) {
+                matched[i] = k;
+                taken[k] = true;
+                // Another window, the game may be anywhere in it
+                locator_reset(&scheduler->instances[i].locator);
+            }
+        }
+    }
+
+    for (int i = 0; i < scheduler->count; i++) {
+        if (matched[i] < 0) {
+            continue;
+        }
+        Instance *instance = &scheduler->instances[i];
+        GameArea *window = &instance->window;
+        const GameArea *found = &windows[matched[i]];
+        bool moved = window->x != found->x || window->y != found->y ||
+                     window->width != found->width || window->height != found->height;
+        *window = *found;
+        // A capture thread keeps its rectangle, so it starts over with the new one
+        if (moved && instance->capture.running) {
+            capture_thread_stop(&instance->capture);
+            capture_thread_start(&instance->capture, scheduler->backend, *window, scheduler->capture_interval_ms);
+        }
+    }
+    scheduler->windows_ms = now + SCHEDULER_WINDOWS_MS;
+}
+
+
+/**
+ * @brief The only place input is sent from
+ */
+static void scheduler_dispatch(Scheduler *scheduler, Instance *instance, CoordId target) {
+    input_begin(&scheduler->input);
+    input_click(&scheduler->input, coord_absolute(&instance->coords, target));
+    input_submit(scheduler->backend, &scheduler->input);
+    instance->clicks++;
+    scheduler->dispatched++;
+}
+
+
+/**
+ * @brief Presses Esc in the window of the client. The key goes to the focused window,
+ * so the client's window is brought to the front first; if it can't be, no key is sent
+ * rather than one to another client.
+ */
+static void scheduler_escape(Scheduler *scheduler, Instance *instance) {
+    Backend *backend = scheduler->backend;
+    if (!backend->focus(backend, &instance->window)) {
+        if (wait_verbose) {
+            printf("\nWatchdog: window %d can't be focused, Esc skipped", (int)(instance - scheduler->instances));
+        }
+        return;
+    }
+    input_begin(&scheduler->input);
+    input_key(&scheduler->input, INPUT_KEY_ESCAPE);
+    input_submit(backend, &scheduler->input);
+    scheduler->dispatched++;
+}
+
+
+/**
+ * @brief Lets the watchdog look at the client after its bot, and takes the recovery step it calls for
+ * @return true if a step was taken
+ */
+static bool scheduler_watch(Scheduler *scheduler, Instance *instance, uint64_t now) {
+    Watchdog *watchdog = &instance->watchdog;
+    Bot *bot = &instance->bot;
+    const GameConfig *config = bot->config;
+    int index = (int)(instance - scheduler->instances);
+    int incidents = watchdog->incidents, recovered = watchdog->recovered;
+    uint64_t downtime = watchdog->downtime_ms;
+
+    const RecoveryStep *step = watchdog_update(watchdog, bot->state, bot->progress, now);
+    if (watchdog->recovered != recovered) {
+        telemetry_record(bot->telemetry, TELEMETRY_RECOVERED, index, bot->state, watchdog->last_kind,
+                         (uint32_t)(watchdog->downtime_ms - downtime), now);
+        if (wait_verbose) {
+            printf("\nWatchdog: window %d recovered by %s after %.1f s, now on %s", index, recovery_name(watchdog->last_kind),
+                   (watchdog->downtime_ms - downtime) / 1000.0, config_state_name(config, bot->state));
+        }
+    }
+    if (step == NULL) {
+        return false;
+    }
+    if (watchdog->incidents != incidents) {
+        telemetry_record(bot->telemetry, TELEMETRY_STALL, index, watchdog->stuck_state, 0,
+                         (uint32_t)(now - watchdog->progress_ms), now);
+        if (wait_verbose) {
+            printf("\nWatchdog: window %d stuck on %s for %.1f s", index, config_state_name(config, watchdog->stuck_state),
+                   (now - watchdog->progress_ms) / 1000.0);
+        }
+    }
+    telemetry_record(bot->telemetry, TELEMETRY_RECOVERY, index, bot->state, step->kind, (uint32_t)(now - watchdog->progress_ms), now);
+    if (wait_verbose) {
+        printf("\nWatchdog: window %d: %s%s%s", index, recovery_name(step->kind), step->kind == RECOVERY_CLOSE ? " " : "",
+               step->kind == RECOVERY_CLOSE ? config_coord_name(config, step->target) : "");
+    }
+
+    const Routine *routine = NULL;
+    switch (step->kind) {
+        case RECOVERY_ESCAPE:
+            scheduler_escape(scheduler, instance);
+            break;
+        case RECOVERY_CLOSE:
+            scheduler_dispatch(scheduler, instance, step->target);
+            break;
+        case RECOVERY_HOME:
+            routine = &config->routines[config->watchdog.home_routine];
+            break;
+        case RECOVERY_RESTART:
+            if (scheduler->restart == NULL || !scheduler->restart(scheduler->restart_ctx, index, &instance->window)) {
+                printf("\nError: Failed to restart the game client of window %d.\n", index);
+            }
+            // The restarted client may come up anywhere
+            locator_reset(&instance->locator);
+            scheduler_refresh_windows(scheduler, now);
+            break;
+        case RECOVERY_REANCHOR:
+            locator_reset(&instance->locator);
+            scheduler_refresh_windows(scheduler, now);
+            break;
+        case RECOVERY_KIND_COUNT:
+            break;
+    }
+    // The screen changed under the bot
+    bot_interrupt(bot, routine);
+    return true;
+}
+
+
+/**
+ * @brief Captures one window, recognizes it and acts on it
+ */
+static void scheduler_serve(Scheduler *scheduler, Instance *instance, uint64_t now) {
+    Backend *backend = scheduler->backend;
+    BotDecision decision = {false, 0, WAIT_MAX_POLL_MS};
+    const GameArea *window = &instance->window;
+    const Frame *frame = &instance->frame;
+    bool captured;
+    if (instance->capture.running) {
+        // Only a frame the bot has not seen yet: an old one looks like a screen that stopped moving
+        bool fresh = false;
+        frame = capture_thread_latest(&instance->capture, &fresh);
+        captured = frame != NULL && fresh;
+        if (!captured) {
+            decision.delay_ms = WAIT_MIN_POLL_MS;
+        }
+    }
+    else {
+        captured = backend->capture(backend, window->x, window->y, window->width, window->height, &instance->frame);
+    }
+    if (captured) {
+        // What the frame shows is as old as the capture, not as the time it is looked at
+        coord_table_refresh(&instance->coords, backend, locator_update(&instance->locator, frame, frame->time_ms));
+        decision = bot_step(&instance->bot, frame, frame->time_ms);
+        // A recovery step replaces the bot's action, the bot looks again once the screen followed it
+        if (scheduler_watch(scheduler, instance, now)) {
+            decision.click = false;
+            decision.delay_ms = WATCHDOG_SETTLE_MS;
+        }
+    }
+
+    if (decision.click) {
+        scheduler_dispatch(scheduler, instance, decision.target);
+    }
+    instance->wake_ms = backend->now_ms(backend) + decision.delay_ms;
+}
+
+
+bool scheduler_init(Scheduler *scheduler, Backend *backend, const GameConfig *config, const GameMode *mode,
+                    const Anchor *anchor, unsigned settle_ms, Telemetry *telemetry) {
+    memset(scheduler, 0, sizeof(*scheduler));
+    scheduler->backend = backend;
+
+    GameArea windows[SCHEDULER_MAX_INSTANCES];
+    scheduler->count = backend->windows(backend, windows, SCHEDULER_MAX_INSTANCES);
+    if (scheduler->count <= 0) {
+        printf("\nError: No game window found.\n");
+        return false;
+    }
+
+    uint64_t now = backend->now_ms(backend);
+    for (int i = 0; i < scheduler->count; i++) {
+        Instance *instance = &scheduler->instances[i];
+        instance->window = windows[i];
+        coord_table_set_custom(&instance->coords, config->points, config->point_count);
+        locator_init(&instance->locator, anchor);
+        bot_init(&instance->bot, config, mode, &instance->coords, settle_ms);
+        instance->bot.telemetry = telemetry;
+        instance->bot.instance = i;
+        watchdog_init(&instance->watchdog, config, false, now);
+        instance->wake_ms = now;
+    }
+    scheduler->windows_ms = now + SCHEDULER_WINDOWS_MS;
+    return true;
+}
+
+
+bool scheduler_start_capture(Scheduler *scheduler, unsigned interval_ms) {
+    scheduler->capture_interval_ms = interval_ms;
+    for (int i = 0; i < scheduler->count; i++) {
+        Instance *instance = &scheduler->instances[i];
+        if (!capture_thread_start(&instance->capture, scheduler->backend, instance->window, interval_ms)) {
+            for (int j = 0; j < i; j++) {
+                capture_thread_stop(&scheduler->instances[j].capture);
+            }
+            return false;
+        }
+    }
+    return true;
+}
+
+
+void scheduler_set_restart(Scheduler *scheduler, RestartHook restart, void *ctx) {
+    scheduler->restart = restart;
+    scheduler->restart_ctx = ctx;
+    uint64_t now = scheduler->backend->now_ms(scheduler->backend);
+    for (int i = 0; i < scheduler->count; i++) {
+        Instance *instance = &scheduler->instances[i];
+        watchdog_init(&instance->watchdog, instance->bot.config, restart != NULL, now);
+    }
+}
+
+
+void scheduler_free(Scheduler *scheduler) {
+    for (int i = 0; i < scheduler->count; i++) {
+        capture_thread_stop(&scheduler->instances[i].capture);
+        frame_free(&scheduler->instances[i].frame);
+        locator_free(&scheduler->instances[i].locator);
+    }
+    scheduler->count = 0;
+}
+
+
+void scheduler_run(Scheduler *scheduler, uint64_t until_ms) {
+    Backend *backend = scheduler->backend;
+    while (1) {
+        uint64_t now = backend->now_ms(backend);
+        if (until_ms != 0 && now >= until_ms) {
+            break;
+        }
+        if (now >= scheduler->windows_ms) {
+            scheduler_refresh_windows(scheduler, now);
+        }
+
+        // Earliest wake-up first; ties go to the lower index
+        Instance *next = &scheduler->instances[0];
+        for (int i = 1; i < scheduler->count; i++) {
+            if (scheduler->instances[i].wake_ms < next->wake_ms) {
+                next = &scheduler->instances[i];
+            }
+        }
+
+        if (next->wake_ms > now) {
+            uint64_t delay = next->wake_ms - now;
+            if (until_ms != 0 && until_ms - now < delay) {
+                delay = until_ms - now;
+            }
+            backend->sleep_ms(backend, (unsigned)delay);
+            continue;
+        }
+        scheduler_serve(scheduler, next, now);
+    }
+}
@@ -0,0 +1,91 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "backend.h"
+#include "bot.h"
+#include "capture.h"
+#include "config.h"
+#include "coords.h"
+#include "frame.h"
+#include "input.h"
+#include "locator.h"
+#include "telemetry.h"
+#include "watchdog.h"
+
+#define SCHEDULER_MAX_INSTANCES 16
+
+// How often the list of game windows is refreshed, to follow moved windows (ms)
+#define SCHEDULER_WINDOWS_MS 2000
+
+/**
+ * @brief One game client: its window, its own capture, geometry and state machine
+ */
+typedef struct {
+    GameArea window;    // Screen rectangle captured for this client
+    Frame frame;
+    CaptureThread capture;  // Captures the window once scheduler_start_capture() was called
+    Locator locator;
+    CoordTable coords;
+    Bot bot;
+    Watchdog watchdog;  // Notices when the client is stuck and tries to get it going again
+    uint64_t wake_ms;   // When to look at the window again
+    int clicks;
+} Instance;
+
+/**
+ * @brief Restarts the game client of an instance, for the last step of the recovery playbook
+ * @param window The window the client is in
+ * @return false if the restart could not be started
+ */
+typedef bool (*RestartHook)(void *ctx, int instance, const GameArea *window);
+
+/**
+ * @brief Farms every game window from one thread. The instance that is due next gets
+ * the turn, so while one client plays its battle animation the others get their clicks.
+ * All input goes through one dispatcher, since the windows share the pointer.
+ */
+typedef struct {
+    Backend *backend;
+    Instance instances[SCHEDULER_MAX_INSTANCES];
+    int count;
+    InputSequence input;  // The single input queue, remembers where the pointer was left
+    uint64_t windows_ms;  // Next refresh of the window list
+    int dispatched;       // Input sequences submitted
+    unsigned capture_interval_ms;  // Of the capture threads, see scheduler_start_capture()
+    RestartHook restart;  // NULL: the playbook ends before restarting the client
+    void *restart_ctx;
+} Scheduler;
+
+/**
+ * @brief Sets up an instance for every game window the backend reports
+ * @param anchor Finds the game inside each window, NULL if the game fills its window
+ * @param telemetry Receives the events of every instance, NULL for none
+ * @return false if the backend reports no window
+ */
+bool scheduler_init(Scheduler *scheduler, Backend *backend, const GameConfig *config, const GameMode *mode,
+                    const Anchor *anchor, unsigned settle_ms, Telemetry *telemetry);
+
+/**
+ * @brief Captures every window on its own thread from now on, so a turn looks at the newest
+ * frame instead of waiting for a capture. Only for backends with a real clock.
+ * @param interval_ms Pause between the captures of a window
+ * @return false if a thread could not be started (the windows are captured inline then)
+ */
+bool scheduler_start_capture(Scheduler *scheduler, unsigned interval_ms);
+
+/**
+ * @brief Lets the watchdogs restart a stuck game client as their last resort
+ */
+void scheduler_set_restart(Scheduler *scheduler, RestartHook restart, void *ctx);
+
+void scheduler_free(Scheduler *scheduler);
+
+/**
+ * @brief Serves the instances in order of their wake-up times, sleeping only when none is due
+ * @param until_ms Stop once the backend clock reaches it, 0 to run forever
+ */
+void scheduler_run(Scheduler *scheduler, uint64_t until_ms);
+
+#endif
@@ -0,0 +1,887 @@
+#include <stdlib.h>
+#include <string.h>
+#include "coords.h"
+#include "input.h"
+#include "simulator.h"
+
+// Distance in base pixels within which a click hits a target
+#define SIM_HIT_RADIUS 12
+#define SIM_CLOCK_START 1000
+#define SIM_MAX_CLIENTS 16
+
+// Gap around every window when several are tiled on the screen
+#define SIM_WINDOW_MARGIN 8
+
+// Emblem bar along the top of the client: blocks of random colors, in base pixels
+#define SIM_ANCHOR_X 16
+#define SIM_ANCHOR_Y 8
+#define SIM_ANCHOR_WIDTH 448
+#define SIM_ANCHOR_HEIGHT 32
+#define SIM_ANCHOR_BLOCK 8
+
+typedef enum {
+    SIM_WORLD,
+    SIM_BATTLE,
+    SIM_VICTORY,
+    SIM_TRAIN_WINDOW,
+    SIM_TRAIN_DIALOG,
+    SIM_NEW_ABILITY,
+    SIM_EVOLUTION,
+    SIM_LEVEL_UP,
+    SIM_MENU,
+    SIM_POPUP,
+    SIM_DISCONNECTED,
+    SIM_LOADING
+} SimScreen;
+
+
+/**
+ * @brief The client layout is the one the bot uses, in base 1366x768 coordinates
+ */
+static Point sim_point(CoordId id) {
+    Point point = {COORD_DEFS[id].base_x, COORD_DEFS[id].base_y};
+    return point;
+}
+
+/**
+ * @brief Slot of a team member in the training window
+ */
+static Point sim_slot(int member) {
+    Point point = sim_point(COORD_TRAIN_SLOT);
+    point.x += member * SIM_SLOT_SPACING;
+    return point;
+}
+
+static const RGBColor SIM_START_FIGHT_COLOR = {226, 237, 255};
+static const RGBColor SIM_READY_TO_TRAIN_COLOR = {237, 188, 87};
+static const RGBColor SIM_NEW_ABILITY_COLOR = {103, 122, 144};
+static const RGBColor SIM_EVOLUTION_COLOR = {107, 138, 19};
+static const RGBColor SIM_LEVEL_UP_COLOR = {107, 138, 19};
+static const RGBColor SIM_HP_COLOR = {60, 200, 80};
+
+/**
+ * @brief One game client in its window
+ */
+typedef struct {
+    SimulatorStats stats;
+    GameArea window;            // Client area on the screen
+
+    SimScreen screen;
+    SimScreen pending_screen;
+    uint64_t pending_at;        // 0 when no transition is in flight
+    uint64_t actionable_since;  // When the current screen started waiting for the bot
+
+    uint64_t cooldown_until[SIM_MAX_SPAWNS];
+    int engaged;                // Object of the current fight
+    int enemy_hp;
+    int player_hp;
+    bool player_turn;
+    int wins_since_training[SIM_MAX_TEAM];  // A miscrit is ready to train from fights_per_training on
+    int selected;               // Slot of the training window, -1 for none
+    int dialog_layers;
+    bool platinum;
+    bool ability_pending;
+    bool evolution_pending;
+    bool level_up_pending;
+
+    bool dirty;                 // The window must be redrawn
+    uint64_t drawn_version;     // Screen version of the last redraw
+} SimClient;
+
+/**
+ * @brief What a frame was last filled with, to skip the copy when nothing changed since
+ */
+typedef struct {
+    const Frame *frame;
+    uint64_t version;
+    int x, y, width, height;
+} SimCapture;
+
+typedef struct {
+    SimulatorConfig config;
+    uint64_t now;
+    int missed_clicks;          // Clicks outside every window
+
+    // One pointer for the whole screen
+    Point cursor;
+    bool button_down;
+    Point press_position;
+    int focused;                // Client the keys go to, -1 for none
+
+    SimClient clients[SIM_MAX_CLIENTS];
+    int client_count;
+
+    Anchor anchor;
+    Frame canvas;               // Rendered screen, a window is redrawn only when its screen changes
+    uint64_t version;           // Bumped by every redraw
+    SimCapture captures[SIM_MAX_CLIENTS + 1];
+} SimContext;
+
+
+/**
+ * @brief Whether a team member has the experience to be trained
+ */
+static bool sim_ready(const SimContext *ctx, const SimClient *client, int member) {
+    return client->wins_since_training[member] >= ctx->config.fights_per_training;
+}
+
+
+static int sim_scale_x(const SimClient *client, int base_x) {
+    return client->window.x + base_x * client->window.width / BASE_SCREEN_WIDTH;
+}
+
+
+static int sim_scale_y(const SimClient *client, int base_y) {
+    return client->window.y + base_y * client->window.height / BASE_SCREEN_HEIGHT;
+}
+
+
+/**
+ * @brief Fills the whole client area
+ */
+static void sim_background(SimContext *ctx, SimClient *client, RGBColor color) {
+    frame_fill(&ctx->canvas, client->window.x, client->window.y, client->window.width, client->window.height, color);
+}
+
+
+/**
+ * @brief Paints the anchor emblem scaled to the client, nearest pixel
+ */
+static void sim_paint_anchor(SimContext *ctx, SimClient *client) {
+    const Frame *image = &ctx->anchor.image;
+    int x0 = sim_scale_x(client, SIM_ANCHOR_X), x1 = sim_scale_x(client, SIM_ANCHOR_X + image->width);
+    int y0 = sim_scale_y(client, SIM_ANCHOR_Y), y1 = sim_scale_y(client, SIM_ANCHOR_Y + image->height);
+    for (int y = y0; y < y1; y++) {
+        int source_y = (y - client->window.y) * BASE_SCREEN_HEIGHT / client->window.height - SIM_ANCHOR_Y;
+        for (int x = x0; x < x1; x++) {
+            int source_x = (x - client->window.x) * BASE_SCREEN_WIDTH / client->window.width - SIM_ANCHOR_X;
+            if (source_x >= 0 && source_y >= 0 && source_x < image->width && source_y < image->height) {
+                frame_set(&ctx->canvas, x, y, pixel_to_rgb(image->pixels[(size_t)source_y * image->stride + source_x]));
+            }
+        }
+    }
+}
+
+
+/**
+ * @brief Places the windows: the configured one for a single client, otherwise a grid
+ * of equal windows keeping the game's aspect ratio
+ */
+static void sim_layout(SimContext *ctx) {
+    const SimulatorConfig *config = &ctx->config;
+    if (ctx->client_count == 1) {
+        GameArea window = {config->window_x, config->window_y, config->window_width, config->window_height, 1};
+        if (window.width <= 0 || window.height <= 0) {
+            GameArea screen = {0, 0, config->screen_width, config->screen_height, 1};
+            window = screen;
+        }
+        ctx->clients[0].window = window;
+        return;
+    }
+
+    int columns = 1;
+    while (columns * columns < ctx->client_count) {
+        columns++;
+    }
+    int rows = (ctx->client_count + columns - 1) / columns;
+    int cell_width = config->screen_width / columns, cell_height = config->screen_height / rows;
+    int width = cell_width - 2 * SIM_WINDOW_MARGIN, height = width * BASE_SCREEN_HEIGHT / BASE_SCREEN_WIDTH;
+    if (height > cell_height - 2 * SIM_WINDOW_MARGIN) {
+        height = cell_height - 2 * SIM_WINDOW_MARGIN;
+        width = height * BASE_SCREEN_WIDTH / BASE_SCREEN_HEIGHT;
+    }
+    for (int i = 0; i < ctx->client_count; i++) {
+        GameArea window = {(i % columns) * cell_width + (cell_width - width) / 2, (i / columns) * cell_height + (cell_height - height) / 2,
+                           width, height, (uintptr_t)i + 1};
+        ctx->clients[i].window = window;
+    }
+}
+
+
+/**
+ * @brief Desktop around the game windows: a gradient with a few windows of its own
+ */
+static void sim_paint_desktop(SimContext *ctx) {
+    Frame *canvas = &ctx->canvas;
+    for (int y = 0; y < canvas->height; y++) {
+        RGBColor color = {20 + y * 60 / canvas->height, 60 + y * 40 / canvas->height, 110};
+        frame_fill(canvas, 0, y, canvas->width, 1, color);
+    }
+    static const RGBColor panel = {230, 230, 230}, title = {40, 70, 140};
+    for (int i = 0; i < 4; i++) {
+        int x = (i * 397) % canvas->width, y = (i * 211) % canvas->height;
+        frame_fill(canvas, x, y, 300, 200, panel);
+        frame_fill(canvas, x, y, 300, 24, title);
+    }
+}
+
+
+/**
+ * @brief Paints a patch of width x height base pixels centered on a base point
+ */
+static void sim_patch(SimContext *ctx, SimClient *client, Point center, int width, int height, RGBColor color) {
+    int x0 = sim_scale_x(client, center.x - width / 2), y0 = sim_scale_y(client, center.y - height / 2);
+    int x1 = sim_scale_x(client, center.x + width / 2 + 1), y1 = sim_scale_y(client, center.y + height / 2 + 1);
+    frame_fill(&ctx->canvas, x0, y0, x1 - x0, y1 - y0, color);
+}
+
+
+/**
+ * @brief A health bar filled to percent, with the HP printed over the middle of it
+ */
+static void sim_health_bar(SimContext *ctx, SimClient *client, int base_x, int percent) {
+    static const RGBColor empty = {48, 40, 40}, text = {250, 250, 250};
+    int x0 = sim_scale_x(client, base_x), x1 = sim_scale_x(client, base_x + SIM_BAR_WIDTH);
+    int y0 = sim_scale_y(client, SIM_BAR_Y), y1 = sim_scale_y(client, SIM_BAR_Y + SIM_BAR_HEIGHT);
+    int fill = x0 + (x1 - x0) * (percent < 0 ? 0 : percent) / 100;
+    frame_fill(&ctx->canvas, x0, y0, x1 - x0, y1 - y0, empty);
+    frame_fill(&ctx->canvas, x0, y0, fill - x0, y1 - y0, SIM_HP_COLOR);
+    int middle = sim_scale_x(client, base_x + SIM_BAR_WIDTH / 2 - 9);
+    frame_fill(&ctx->canvas, middle, y0 + 2, sim_scale_x(client, base_x + SIM_BAR_WIDTH / 2 + 9) - middle, y1 - y0 - 4, text);
+}
+
+
+static void sim_render(SimContext *ctx, SimClient *client) {
+    static const RGBColor world_bg = {62, 94, 58}, battle_bg = {34, 30, 52}, victory_bg = {22, 20, 36};
+    static const RGBColor window_bg = {204, 190, 168}, dialog_bg = {240, 232, 214};
+    static const RGBColor object = {150, 110, 70}, blue_button = {40, 120, 220}, yellow_button = {250, 200, 40};
+    static const RGBColor slot = {120, 100, 80}, slot_selected = {90, 200, 90}, close_button = {200, 50, 50};
+    static const RGBColor grey_button = {90, 90, 96}, grey_line = {110, 110, 110}, menu_bg = {70, 64, 84}, popup_bg = {246, 226, 160};
+    static const RGBColor dark = {12, 12, 16};
+    switch (client->screen) {
+        case SIM_MENU:
+            sim_background(ctx, client, menu_bg);
+            for (int i = 0; i < 5; i++) {
+                sim_patch(ctx, client, (Point){683, 200 + 90 * i}, 300, 60, window_bg);
+            }
+            break;
+        case SIM_DISCONNECTED:
+        case SIM_LOADING:
+            sim_background(ctx, client, dark);
+            if (client->screen == SIM_DISCONNECTED) {
+                sim_patch(ctx, client, (Point){683, 384}, 400, 160, window_bg);
+            }
+            break;
+        case SIM_WORLD:
+        case SIM_LEVEL_UP:
+        case SIM_POPUP:
+            sim_background(ctx, client, world_bg);
+            for (int i = 0; i < ctx->config.spawn_count; i++) {
+                sim_patch(ctx, client, ctx->config.spawns[i].position, 40, 40, object);
+            }
+            sim_patch(ctx, client, sim_point(COORD_TRAIN_OPEN), 30, 20, blue_button);
+            if (client->screen == SIM_LEVEL_UP) {
+                sim_patch(ctx, client, sim_point(COORD_LEVEL_UP), 30, 12, SIM_LEVEL_UP_COLOR);
+                sim_patch(ctx, client, sim_point(COORD_LEVEL_UP_CLOSE), 60, 20, yellow_button);
+            }
+            // The popup covers the middle of the world, the objects included
+            if (client->screen == SIM_POPUP) {
+                sim_patch(ctx, client, (Point){683, 420}, 640, 400, popup_bg);
+                sim_patch(ctx, client, (Point){SIM_POPUP_CLOSE_X, SIM_POPUP_CLOSE_Y}, 24, 24, close_button);
+            }
+            break;
+        case SIM_BATTLE:
+            sim_background(ctx, client, battle_bg);
+            sim_patch(ctx, client, sim_point(COORD_START_FIGHT), 60, 8, SIM_START_FIGHT_COLOR);
+            // The buttons are lit only on the player's turn
+            for (int i = 0; i < ctx->config.ability_count; i++) {
+                sim_patch(ctx, client, ctx->config.abilities[i].position, 50, 30, client->player_turn ? blue_button : grey_button);
+            }
+            sim_health_bar(ctx, client, SIM_ENEMY_BAR_X, client->enemy_hp * 100 / (ctx->config.enemy_hp > 0 ? ctx->config.enemy_hp : 1));
+            sim_health_bar(ctx, client, SIM_PLAYER_BAR_X, client->player_hp);
+            break;
+        case SIM_VICTORY:
+            sim_background(ctx, client, victory_bg);
+            sim_patch(ctx, client, sim_point(COORD_CLOSE_FIGHT), 60, 24, yellow_button);
+            for (int i = 0; i < ctx->config.team_size; i++) {
+                Point line = {sim_point(COORD_GOLDEN_LINE).x, sim_point(COORD_GOLDEN_LINE).y + i * SIM_LINE_SPACING};
+                sim_patch(ctx, client, line, 80, 4, sim_ready(ctx, client, i) ? SIM_READY_TO_TRAIN_COLOR : grey_line);
+            }
+            break;
+        case SIM_TRAIN_WINDOW:
+        case SIM_TRAIN_DIALOG:
+        case SIM_NEW_ABILITY:
+        case SIM_EVOLUTION:
+            sim_background(ctx, client, window_bg);
+            for (int i = 0; i < ctx->config.team_size; i++) {
+                Point position = sim_slot(i), mark = {position.x, position.y + SIM_MARK_OFFSET};
+                sim_patch(ctx, client, position, 60, 40, client->selected == i ? slot_selected : slot);
+                if (sim_ready(ctx, client, i)) {
+                    sim_patch(ctx, client, mark, 40, 4, SIM_READY_TO_TRAIN_COLOR);
+                }
+            }
+            sim_patch(ctx, client, sim_point(COORD_TRAIN_BUTTON), 50, 20, blue_button);
+            sim_patch(ctx, client, sim_point(COORD_TRAIN_CLOSE), 20, 20, close_button);
+            if (client->screen == SIM_TRAIN_DIALOG) {
+                // Every layer of the dialog looks different, like the real reward/summary pages
+                RGBColor layer = {dialog_bg.r - 30 * client->dialog_layers, dialog_bg.g, dialog_bg.b};
+                sim_patch(ctx, client, (Point){700, 500}, 400, 300, layer);
+                sim_patch(ctx, client, sim_point(COORD_TRAIN_DIALOG_CLOSE), 60, 20, yellow_button);
+                sim_patch(ctx, client, sim_point(COORD_TRAIN_PLATINUM), 50, 20, blue_button);
+            }
+            if (client->screen == SIM_NEW_ABILITY) {
+                sim_patch(ctx, client, sim_point(COORD_NEW_ABILITY), 30, 12, SIM_NEW_ABILITY_COLOR);
+                sim_patch(ctx, client, sim_point(COORD_NEW_ABILITY_CLOSE), 60, 20, yellow_button);
+            }
+            // A pending evolution is already visible under the ability popup
+            if (client->screen == SIM_EVOLUTION || (client->screen == SIM_NEW_ABILITY && client->evolution_pending)) {
+                sim_patch(ctx, client, sim_point(COORD_EVOLUTION), 30, 12, SIM_EVOLUTION_COLOR);
+                sim_patch(ctx, client, sim_point(COORD_EVOLUTION_CLOSE), 60, 20, yellow_button);
+            }
+            break;
+    }
+    sim_paint_anchor(ctx, client);
+    client->dirty = false;
+    client->drawn_version = ++ctx->version;
+}
+
+
+static void sim_set_screen(SimContext *ctx, SimClient *client, SimScreen screen, uint64_t at) {
+    // Back to the battle after the enemy's move, or into a new one
+    if (screen == SIM_BATTLE && client->screen == SIM_BATTLE) {
+        client->player_hp -= ctx->config.enemy_damage;
+        if (client->player_hp < 1) {
+            client->player_hp = 1;
+        }
+    }
+    else if (screen == SIM_BATTLE) {
+        client->enemy_hp = ctx->config.enemy_hp;
+        client->player_hp = 100;
+    }
+    client->player_turn = true;
+    client->screen = screen;
+    client->actionable_since = at;
+    client->dirty = true;
+
+    if (screen == SIM_VICTORY) {
+        client->stats.fights++;
+        client->stats.spawn_fights[client->engaged]++;
+        client->cooldown_until[client->engaged] = at + ctx->config.spawns[client->engaged].cooldown_ms;
+        for (int i = 0; i < ctx->config.team_size; i++) {
+            client->wins_since_training[i]++;
+        }
+    }
+    // The world view is actionable only once an object is off cooldown
+    if (screen == SIM_WORLD) {
+        uint64_t ready = client->cooldown_until[0];
+        for (int i = 1; i < ctx->config.spawn_count; i++) {
+            if (client->cooldown_until[i] < ready) {
+                ready = client->cooldown_until[i];
+            }
+        }
+        if (ready > at) {
+            client->actionable_since = ready;
+        }
+    }
+}
+
+
+/**
+ * @brief Applies the transitions whose latency has passed
+ */
+static void sim_advance(SimContext *ctx) {
+    for (int i = 0; i < ctx->client_count; i++) {
+        SimClient *client = &ctx->clients[i];
+        if (client->pending_at != 0 && ctx->now >= client->pending_at) {
+            uint64_t at = client->pending_at;
+            client->pending_at = 0;
+            sim_set_screen(ctx, client, client->pending_screen, at);
+        }
+    }
+}
+
+
+static void sim_transition(SimContext *ctx, SimClient *client, SimScreen screen, unsigned latency_ms) {
+    if (ctx->now > client->actionable_since) {
+        client->stats.idle_ms += ctx->now - client->actionable_since;
+    }
+    client->pending_screen = screen;
+    client->pending_at = ctx->now + (latency_ms > 0 ? latency_ms : 1);
+}
+
+
+static bool sim_hit(Point click, Point target) {
+    return abs(click.x - target.x) <= SIM_HIT_RADIUS && abs(click.y - target.y) <= SIM_HIT_RADIUS;
+}
+
+
+/**
+ * @brief Screen the training window returns to after the dialogs and popups of one training
+ */
+static SimScreen sim_after_training(const SimClient *client) {
+    if (client->ability_pending) return SIM_NEW_ABILITY;
+    if (client->evolution_pending) return SIM_EVOLUTION;
+    return SIM_TRAIN_WINDOW;
+}
+
+
+static void sim_click(SimContext *ctx, SimClient *client, Point position) {
+    const SimulatorConfig *config = &ctx->config;
+    // Back to base coordinates for hit testing
+    Point click = {(position.x - client->window.x) * BASE_SCREEN_WIDTH / client->window.width,
+                   (position.y - client->window.y) * BASE_SCREEN_HEIGHT / client->window.height};
+
+    // Clicks during a transition are swallowed by the client
+    if (client->pending_at != 0) {
+        client->stats.missed_clicks++;
+        return;
+    }
+
+    switch (client->screen) {
+        case SIM_WORLD:
+            for (int i = 0; i < config->spawn_count; i++) {
+                if (sim_hit(click, config->spawns[i].position) && ctx->now >= client->cooldown_until[i]) {
+                    client->engaged = i;
+                    sim_transition(ctx, client, SIM_BATTLE, config->fight_start_ms);
+                    return;
+                }
+            }
+            if (sim_hit(click, sim_point(COORD_TRAIN_OPEN))) {
+                client->stats.window_opens++;
+                sim_transition(ctx, client, SIM_TRAIN_WINDOW, config->dialog_ms);
+                return;
+            }
+            break;
+        case SIM_BATTLE:
+            for (int i = 0; i < config->ability_count && client->player_turn; i++) {
+                const SimAbility *ability = &config->abilities[i];
+                if (sim_hit(click, ability->position)) {
+                    client->stats.turns++;
+                    client->enemy_hp -= client->enemy_hp <= ability->finisher_hp ? client->enemy_hp : ability->damage;
+                    client->player_turn = false;
+                    client->dirty = true;
+                    sim_transition(ctx, client, client->enemy_hp <= 0 ? SIM_VICTORY : SIM_BATTLE,
+                                   client->enemy_hp <= 0 ? config->battle_ms : config->turn_ms);
+                    return;
+                }
+            }
+            break;
+        case SIM_VICTORY:
+            if (sim_hit(click, sim_point(COORD_CLOSE_FIGHT))) {
+                sim_transition(ctx, client, SIM_WORLD, config->close_ms);
+                return;
+            }
+            break;
+        case SIM_TRAIN_WINDOW:
+            for (int i = 0; i < config->team_size; i++) {
+                if (sim_hit(click, sim_slot(i))) {
+                    client->selected = i;
+                    client->dirty = true;
+                    return;
+                }
+            }
+            if (sim_hit(click, sim_point(COORD_TRAIN_BUTTON)) && client->selected >= 0 && sim_ready(ctx, client, client->selected)) {
+                int training = ++client->stats.trainings;
+                // Experience beyond the level stays, so a miscrit may be ready again right away
+                client->wins_since_training[client->selected] -= config->fights_per_training;
+                client->dialog_layers = 2;
+                client->platinum = false;
+                client->ability_pending = config->ability_every > 0 && training % config->ability_every == 0;
+                client->evolution_pending = config->evolution_every > 0 && training % config->evolution_every == 0;
+                client->level_up_pending = client->level_up_pending || (config->level_up_every > 0 && training % config->level_up_every == 0);
+                sim_transition(ctx, client, SIM_TRAIN_DIALOG, config->dialog_ms);
+                return;
+            }
+            if (sim_hit(click, sim_point(COORD_TRAIN_CLOSE))) {
+                client->selected = -1;
+                sim_transition(ctx, client, client->level_up_pending ? SIM_LEVEL_UP : SIM_WORLD, config->dialog_ms);
+                client->level_up_pending = false;
+                return;
+            }
+            break;
+        case SIM_TRAIN_DIALOG:
+            // Training with platinum goes through one more confirmation page
+            if (sim_hit(click, sim_point(COORD_TRAIN_PLATINUM)) && !client->platinum) {
+                client->platinum = true;
+                client->dialog_layers++;
+            }
+            if (sim_hit(click, sim_point(COORD_TRAIN_DIALOG_CLOSE)) || sim_hit(click, sim_point(COORD_TRAIN_PLATINUM)) || sim_hit(click, sim_point(COORD_TRAIN_PLATINUM_CONFIRM))) {
+                if (--client->dialog_layers > 0) {
+                    sim_transition(ctx, client, SIM_TRAIN_DIALOG, config->dialog_ms);
+                }
+                else {
+                    sim_transition(ctx, client, sim_after_training(client), config->dialog_ms);
+                }
+                return;
+            }
+            break;
+        case SIM_NEW_ABILITY:
+            if (sim_hit(click, sim_point(COORD_NEW_ABILITY_CLOSE))) {
+                client->ability_pending = false;
+                sim_transition(ctx, client, sim_after_training(client), config->dialog_ms);
+                return;
+            }
+            break;
+        case SIM_EVOLUTION:
+            if (sim_hit(click, sim_point(COORD_EVOLUTION_CLOSE))) {
+                client->evolution_pending = false;
+                sim_transition(ctx, client, sim_after_training(client), config->dialog_ms);
+                return;
+            }
+            break;
+        case SIM_LEVEL_UP:
+            if (sim_hit(click, sim_point(COORD_LEVEL_UP_CLOSE))) {
+                sim_transition(ctx, client, SIM_WORLD, config->dialog_ms);
+                return;
+            }
+            break;
+        case SIM_POPUP:
+            if (sim_hit(click, (Point){SIM_POPUP_CLOSE_X, SIM_POPUP_CLOSE_Y})) {
+                sim_transition(ctx, client, SIM_WORLD, config->dialog_ms);
+                return;
+            }
+            break;
+        case SIM_MENU:
+        case SIM_DISCONNECTED:
+        case SIM_LOADING:
+            break;
+    }
+    client->stats.missed_clicks++;
+}
+
+
+static bool sim_intersects(const GameArea *window, int x, int y, int width, int height) {
+    return window->x < x + width && x < window->x + window->width && window->y < y + height && y < window->y + window->height;
+}
+
+
+static bool sim_capture(Backend *self, int x, int y, int width, int height, Frame *frame) {
+    SimContext *ctx = self->ctx;
+    sim_advance(ctx);
+    for (int i = 0; i < ctx->client_count; i++) {
+        if (ctx->clients[i].dirty) {
+            sim_render(ctx, &ctx->clients[i]);
+        }
+    }
+
+    // Clipping the requested rectangle to the screen
+    if (x < 0) { width += x; x = 0; }
+    if (y < 0) { height += y; y = 0; }
+    if (x + width > ctx->canvas.width) width = ctx->canvas.width - x;
+    if (y + height > ctx->canvas.height) height = ctx->canvas.height - y;
+
+    // The frame still holds exactly this picture if no window in the rectangle was redrawn
+    // since it was filled: a real capture would copy the same pixels
+    SimCapture *last = NULL;
+    for (int i = 0; i <= SIM_MAX_CLIENTS && last == NULL; i++) {
+        if (ctx->captures[i].frame == frame || ctx->captures[i].frame == NULL || i == SIM_MAX_CLIENTS) {
+            last = &ctx->captures[i];
+        }
+    }
+    bool unchanged = last->frame == frame && frame->x == x && frame->y == y && frame->width == width && frame->height == height &&
+                     last->x == x && last->y == y && last->width == width && last->height == height;
+    for (int i = 0; i < ctx->client_count && unchanged; i++) {
+        const SimClient *client = &ctx->clients[i];
+        unchanged = client->drawn_version <= last->version || !sim_intersects(&client->window, x, y, width, height);
+    }
+    if (!unchanged) {
+        if (!frame_reserve(frame, width, height)) {
+            return false;
+        }
+        for (int row = 0; row < height; row++) {
+            memcpy(frame->pixels + (size_t)row * frame->stride,
+                   ctx->canvas.pixels + (size_t)(y + row) * ctx->canvas.stride + x,
+                   (size_t)width * sizeof(uint32_t));
+        }
+        frame->x = x;
+        frame->y = y;
+        SimCapture capture = {frame, ctx->version, x, y, width, height};
+        *last = capture;
+    }
+    frame->sequence++;
+
+    ctx->now += ctx->config.capture_ms;
+    frame->time_ms = ctx->now;
+    return true;
+}
+
+
+static void sim_move(SimContext *ctx, int x, int y) {
+    // Absolute input units back to client pixels, rounding to the nearest one
+    ctx->cursor.x = (int)(((int64_t)x * ctx->config.screen_width + ABSOLUTE_RANGE / 2) / ABSOLUTE_RANGE);
+    ctx->cursor.y = (int)(((int64_t)y * ctx->config.screen_height + ABSOLUTE_RANGE / 2) / ABSOLUTE_RANGE);
+}
+
+
+static void sim_button(SimContext *ctx, bool down) {
+    if (down) {
+        ctx->button_down = true;
+        ctx->press_position = ctx->cursor;
+    }
+    // A click registers on release, if the pointer did not move away while pressed
+    else if (ctx->button_down) {
+        ctx->button_down = false;
+        if (ctx->press_position.x != ctx->cursor.x || ctx->press_position.y != ctx->cursor.y) {
+            return;
+        }
+        for (int i = 0; i < ctx->client_count; i++) {
+            SimClient *client = &ctx->clients[i];
+            if (sim_intersects(&client->window, ctx->cursor.x, ctx->cursor.y, 1, 1)) {
+                // Like a window manager, a click brings its window to the front
+                ctx->focused = i;
+                sim_click(ctx, client, ctx->cursor);
+                return;
+            }
+        }
+        ctx->missed_clicks++;
+    }
+}
+
+
+/**
+ * @brief A key goes to the focused window when it is released, wherever the pointer is.
+ * Only Esc does anything: it closes the menu, back to the world view.
+ */
+static void sim_key(SimContext *ctx, int key) {
+    if (ctx->focused < 0) {
+        return;
+    }
+    SimClient *client = &ctx->clients[ctx->focused];
+    if (key == INPUT_KEY_ESCAPE && client->screen == SIM_MENU && client->pending_at == 0) {
+        sim_transition(ctx, client, SIM_WORLD, ctx->config.dialog_ms);
+    }
+}
+
+
+static void sim_send(Backend *self, const InputEvent *events, int count) {
+    SimContext *ctx = self->ctx;
+    for (int i = 0; i < count; i++) {
+        sim_advance(ctx);
+        if (events[i].type == INPUT_EVENT_MOVE) {
+            sim_move(ctx, events[i].x, events[i].y);
+        }
+        else if (events[i].type == INPUT_EVENT_KEY_UP) {
+            sim_key(ctx, events[i].x);
+        }
+        else if (events[i].type != INPUT_EVENT_KEY_DOWN) {
+            sim_button(ctx, events[i].type == INPUT_EVENT_PRESS);
+        }
+        ctx->now += events[i].hold_ms;
+    }
+    sim_advance(ctx);
+}
+
+
+static ScreenMetrics sim_metrics(Backend *self) {
+    SimContext *ctx = self->ctx;
+    ScreenMetrics metrics = {ctx->config.screen_width, ctx->config.screen_height};
+    return metrics;
+}
+
+
+/**
+ * @brief Front to back like EnumWindows: the focused window first, then the others
+ */
+static int sim_windows(Backend *self, GameArea *windows, int max) {
+    SimContext *ctx = self->ctx;
+    int count = 0;
+    if (ctx->focused >= 0 && count < max) {
+        windows[count++] = ctx->clients[ctx->focused].window;
+    }
+    for (int i = 0; i < ctx->client_count && count < max; i++) {
+        if (i != ctx->focused) {
+            windows[count++] = ctx->clients[i].window;
+        }
+    }
+    return count;
+}
+
+
+static bool sim_focus(Backend *self, const GameArea *window) {
+    SimContext *ctx = self->ctx;
+    int client = simulator_client(self, window);
+    if (client < 0) {
+        return false;
+    }
+    ctx->focused = client;
+    return true;
+}
+
+
+static uint64_t sim_now_ms(Backend *self) {
+    SimContext *ctx = self->ctx;
+    return ctx->now;
+}
+
+
+static void sim_sleep_ms(Backend *self, unsigned ms) {
+    SimContext *ctx = self->ctx;
+    ctx->now += ms;
+    sim_advance(ctx);
+}
+
+
+static void sim_destroy(Backend *self) {
+    SimContext *ctx = self->ctx;
+    frame_free(&ctx->canvas);
+    anchor_free(&ctx->anchor);
+    free(ctx);
+    free(self);
+}
+
+
+void simulator_default_config(SimulatorConfig *config) {
+    SimulatorConfig defaults = {
+        .screen_width = 1366,
+        .screen_height = 768,
+        .clients = 1,
+        .capture_ms = 5,
+        .fight_start_ms = 1500,
+        .battle_ms = 4000,
+        .turn_ms = 3000,
+        .abilities = {{{COORD_DEFS[COORD_ABILITY].base_x, COORD_DEFS[COORD_ABILITY].base_y}, 100, 0}},
+        .ability_count = 1,
+        .enemy_hp = 100,
+        .enemy_damage = 10,
+        .close_ms = 800,
+        .dialog_ms = 400,
+        .spawns = {{{COORD_DEFS[COORD_WORLD_OBJECT].base_x, COORD_DEFS[COORD_WORLD_OBJECT].base_y}, 20000}},
+        .spawn_count = 1,
+        .fights_per_training = 5,
+        .ability_every = 3,
+        .evolution_every = 10,
+        .level_up_every = 7,
+        .team_size = 1,
+        .restart_ms = 20000,
+    };
+    *config = defaults;
+}
+
+
+Backend *simulator_create(const SimulatorConfig *config) {
+    Backend *backend = calloc(1, sizeof(Backend));
+    SimContext *ctx = calloc(1, sizeof(SimContext));
+    if (backend == NULL || ctx == NULL || !frame_reserve(&ctx->canvas, config->screen_width, config->screen_height) ||
+        !simulator_anchor(&ctx->anchor)) {
+        if (ctx != NULL) {
+            frame_free(&ctx->canvas);
+            anchor_free(&ctx->anchor);
+        }
+        free(backend);
+        free(ctx);
+        return NULL;
+    }
+
+    ctx->config = *config;
+    if (ctx->config.fights_per_training < 1) {
+        ctx->config.fights_per_training = 1;
+    }
+    if (ctx->config.spawn_count > SIM_MAX_SPAWNS) {
+        ctx->config.spawn_count = SIM_MAX_SPAWNS;
+    }
+    if (ctx->config.ability_count > SIM_MAX_ABILITIES) {
+        ctx->config.ability_count = SIM_MAX_ABILITIES;
+    }
+    ctx->config.team_size = ctx->config.team_size < 1 ? 1 : ctx->config.team_size > SIM_MAX_TEAM ? SIM_MAX_TEAM : ctx->config.team_size;
+    ctx->client_count = config->clients < 1 ? 1 : config->clients > SIM_MAX_CLIENTS ? SIM_MAX_CLIENTS : config->clients;
+    sim_layout(ctx);
+    sim_paint_desktop(ctx);
+    // The last client started has the focus
+    ctx->focused = ctx->client_count - 1;
+    // The virtual clock starts at an arbitrary non-zero point, like a real tick counter
+    ctx->now = SIM_CLOCK_START;
+    for (int i = 0; i < ctx->client_count; i++) {
+        SimClient *client = &ctx->clients[i];
+        client->selected = -1;
+        for (int k = 0; k < ctx->config.team_size; k++) {
+            client->wins_since_training[k] = k * ctx->config.fights_per_training / ctx->config.team_size;
+        }
+        sim_set_screen(ctx, client, SIM_WORLD, ctx->now);
+    }
+
+    backend->name = "simulator";
+    backend->ctx = ctx;
+    backend->capture = sim_capture;
+    backend->send = sim_send;
+    backend->metrics = sim_metrics;
+    backend->windows = sim_windows;
+    backend->focus = sim_focus;
+    backend->now_ms = sim_now_ms;
+    backend->sleep_ms = sim_sleep_ms;
+    backend->destroy = sim_destroy;
+    return backend;
+}
+
+
+SimulatorStats simulator_stats(Backend *backend) {
+    SimContext *ctx = backend->ctx;
+    SimulatorStats stats = {0};
+    stats.missed_clicks = ctx->missed_clicks;
+    for (int i = 0; i < ctx->client_count; i++) {
+        const SimulatorStats *client = &ctx->clients[i].stats;
+        stats.fights += client->fights;
+        stats.trainings += client->trainings;
+        stats.missed_clicks += client->missed_clicks;
+        stats.idle_ms += client->idle_ms;
+        stats.turns += client->turns;
+        stats.window_opens += client->window_opens;
+        stats.faults += client->faults;
+        stats.restarts += client->restarts;
+        for (int k = 0; k < SIM_MAX_SPAWNS; k++) {
+            stats.spawn_fights[k] += client->spawn_fights[k];
+        }
+    }
+    stats.elapsed_ms = ctx->now - SIM_CLOCK_START;
+    return stats;
+}
+
+
+int simulator_client(Backend *backend, const GameArea *window) {
+    SimContext *ctx = backend->ctx;
+    for (int i = 0; i < ctx->client_count; i++) {
+        if (ctx->clients[i].window.id == window->id) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+
+void simulator_inject(Backend *backend, int client_index, SimFault fault) {
+    SimContext *ctx = backend->ctx;
+    if (client_index < 0 || client_index >= ctx->client_count) {
+        return;
+    }
+    SimClient *client = &ctx->clients[client_index];
+    static const SimScreen screens[] = {SIM_MENU, SIM_POPUP, SIM_DISCONNECTED};
+    client->pending_at = 0;
+    client->selected = -1;
+    client->stats.faults++;
+    sim_set_screen(ctx, client, screens[fault], ctx->now);
+}
+
+
+void simulator_restart(Backend *backend, int client_index) {
+    SimContext *ctx = backend->ctx;
+    if (client_index < 0 || client_index >= ctx->client_count) {
+        return;
+    }
+    SimClient *client = &ctx->clients[client_index];
+    client->stats.restarts++;
+    client->selected = -1;
+    // The restarted client opens a new window in the place of the old one
+    client->window.id += SIM_MAX_CLIENTS;
+    sim_set_screen(ctx, client, SIM_LOADING, ctx->now);
+    client->pending_screen = SIM_WORLD;
+    client->pending_at = ctx->now + (ctx->config.restart_ms > 0 ? ctx->config.restart_ms : 1);
+}
+
+
+bool simulator_anchor(Anchor *anchor) {
+    Frame empty = {0};
+    anchor->image = empty;
+    anchor->base_x = SIM_ANCHOR_X;
+    anchor->base_y = SIM_ANCHOR_Y;
+    if (!frame_reserve(&anchor->image, SIM_ANCHOR_WIDTH, SIM_ANCHOR_HEIGHT)) {
+        return false;
+    }
+    uint32_t seed = 2024;
+    for (int y = 0; y < SIM_ANCHOR_HEIGHT; y += SIM_ANCHOR_BLOCK) {
+        for (int x = 0; x < SIM_ANCHOR_WIDTH; x += SIM_ANCHOR_BLOCK) {
+            seed = seed * 1664525u + 1013904223u;
+            RGBColor color = {(int)(seed >> 24), (int)((seed >> 16) & 0xFF), (int)((seed >> 8) & 0xFF)};
+            frame_fill(&anchor->image, x, y, SIM_ANCHOR_BLOCK, SIM_ANCHOR_BLOCK, color);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,140 @@
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+#include <stdint.h>
+#include "backend.h"
+#include "locator.h"
+
+#define SIM_MAX_SPAWNS 8
+#define SIM_MAX_ABILITIES 4
+#define SIM_MAX_TEAM 4
+
+// Team layout in base pixels: the slots of the training window from train_slot to the right,
+// the ready mark under every slot, the experience lines of the victory screen from golden_line down
+#define SIM_SLOT_SPACING 110
+#define SIM_MARK_OFFSET 34
+#define SIM_LINE_SPACING 30
+
+// Health bars of the battle screen in base pixels (x, y, width, height) and their fill
+#define SIM_ENEMY_BAR_X 900
+#define SIM_PLAYER_BAR_X 150
+#define SIM_BAR_Y 100
+#define SIM_BAR_WIDTH 300
+#define SIM_BAR_HEIGHT 12
+
+// Close button of the reward popup, in base pixels
+#define SIM_POPUP_CLOSE_X 960
+#define SIM_POPUP_CLOSE_Y 250
+
+/**
+ * @brief Screens the bot does not expect, injected with simulator_inject()
+ */
+typedef enum {
+    SIM_FAULT_MENU,        // A misclick opened a menu over the whole client; Esc closes it
+    SIM_FAULT_POPUP,       // A reward popup over the world view; only its close button closes it
+    SIM_FAULT_DISCONNECT   // Connection lost; only a restart of the client helps
+} SimFault;
+
+/**
+ * @brief A world object with a miscrit, in base coordinates
+ */
+typedef struct {
+    Point position;
+    unsigned cooldown_ms;  // It can't be engaged again this long after a fight
+} SimSpawn;
+
+/**
+ * @brief An ability button of the battle screen, in base coordinates
+ */
+typedef struct {
+    Point position;
+    int damage;       // Enemy HP it takes
+    int finisher_hp;  // It takes all the enemy has left once that is at most this, 0 for never
+} SimAbility;
+
+/**
+ * @brief Timings and progression of the simulated Miscrits client. All times are virtual:
+ * sleeping on the simulator only advances its clock, so hours of farming run in seconds.
+ */
+typedef struct {
+    int screen_width;
+    int screen_height;
+    int clients;                  // Game clients, in windows tiled over the screen when more than one
+    int window_x;                 // Window of a single client, 0 width or height: the whole screen
+    int window_y;
+    int window_width;
+    int window_height;
+    unsigned capture_ms;          // Virtual time one capture takes
+    unsigned fight_start_ms;      // Click on the world object -> battle screen
+    unsigned battle_ms;           // Click on the ability that wins -> victory screen
+    unsigned turn_ms;             // Click on an ability that does not win -> the player's next turn
+    SimAbility abilities[SIM_MAX_ABILITIES];  // One at ability that wins in one turn by default
+    int ability_count;
+    int enemy_hp;                 // At the start of a fight
+    int enemy_damage;             // Player HP the enemy takes every turn
+    unsigned close_ms;            // Closing the victory screen -> world
+    unsigned dialog_ms;           // Any training window or popup transition
+    SimSpawn spawns[SIM_MAX_SPAWNS];  // Objects of the area, one at world_object by default
+    int spawn_count;
+    int fights_per_training;      // Wins until a miscrit shows the golden line
+    int team_size;                // Miscrits in the team, every one gains from a win; they start apart in experience
+    int ability_every;            // Every Nth training unlocks a new ability (0 = never)
+    int evolution_every;          // Every Nth training evolves the miscrit (0 = never)
+    int level_up_every;           // Every Nth training raises the player level (0 = never)
+    unsigned restart_ms;          // simulator_restart() -> world
+} SimulatorConfig;
+
+/**
+ * @brief Totals over all clients
+ */
+typedef struct {
+    int fights;          // Battles won
+    int trainings;       // Trainings completed
+    int missed_clicks;   // Clicks that did nothing (wrong screen, cooldown, off target)
+    uint64_t idle_ms;    // Time the client sat on an actionable screen waiting for the bot
+    uint64_t elapsed_ms; // Virtual time since the simulator was created
+    int spawn_fights[SIM_MAX_SPAWNS];  // Battles won, by object
+    int turns;           // Abilities used
+    int window_opens;    // Of the training window
+    int faults;          // Injected with simulator_inject()
+    int restarts;        // Of a client, with simulator_restart()
+} SimulatorStats;
+
+void simulator_default_config(SimulatorConfig *config);
+
+/**
+ * @brief Creates a backend that plays deterministic Miscrits clients: the world object,
+ * the battle, the victory screen with the golden "ready to train" line, the training
+ * dialogs and popups, and the object cooldown. All clients share one screen, one pointer
+ * and one clock; a click goes to the window under the pointer and gives it the focus,
+ * a key goes to the focused window. Windows are listed front to back.
+ */
+Backend *simulator_create(const SimulatorConfig *config);
+
+SimulatorStats simulator_stats(Backend *backend);
+
+/**
+ * @brief Puts a client on a screen the bot does not expect, dropping the transition in flight
+ */
+void simulator_inject(Backend *backend, int client, SimFault fault);
+
+/**
+ * @brief The client in a window of the window list
+ * @return its index, -1 if the window is not open (any more)
+ */
+int simulator_client(Backend *backend, const GameArea *window);
+
+/**
+ * @brief Restarts the game of a client: after a loading screen it shows the world view,
+ * in a new window at the same place
+ */
+void simulator_restart(Backend *backend, int client);
+
+/**
+ * @brief The emblem the simulated client shows in its top-left corner on every screen,
+ * as a window anchor. Free with anchor_free.
+ * @return false if the allocation failed
+ */
+bool simulator_anchor(Anchor *anchor);
+
+#endif
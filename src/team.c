@@ -0,0 +1,23 @@
+#include "recognizer.h"
+#include "team.h"
+
+
+uint32_t team_ready(const GameConfig *config, const CoordTable *coords, const Frame *frame, bool window) {
+    uint32_t members = 0;
+    for (int i = 0; i < config->team_size; i++) {
+        const TeamMember *member = &config->team[i];
+        if (probe_matches(window ? &member->mark : &member->line, coords, frame)) {
+            members |= 1u << i;
+        }
+    }
+    return members;
+}
+
+
+int team_count(uint32_t members) {
+    int count = 0;
+    for (; members != 0; members &= members - 1) {
+        count++;
+    }
+    return count;
+}
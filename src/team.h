@@ -0,0 +1,25 @@
+#ifndef TEAM_H
+#define TEAM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "config.h"
+#include "coords.h"
+#include "frame.h"
+
+// A member still shown ready after this many trainings in one visit of the training window is skipped
+#define TEAM_MAX_TRAININGS 8
+
+/**
+ * @brief Reads which team members are ready to train, every member from the same frame
+ * @param window true for the marks of the training window, false for the lines of the victory screen
+ * @return Bit i set for member i
+ */
+uint32_t team_ready(const GameConfig *config, const CoordTable *coords, const Frame *frame, bool window);
+
+/**
+ * @brief Number of members in a team_ready() result
+ */
+int team_count(uint32_t members);
+
+#endif
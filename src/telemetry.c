@@ -0,0 +1,391 @@
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+#include "backend.h"
+#include "telemetry.h"
+
+static const char *TELEMETRY_EVENT_NAMES[TELEMETRY_EVENT_COUNT] = {
+    [TELEMETRY_PHASE] = "phase",
+    [TELEMETRY_PROBE] = "probe",
+    [TELEMETRY_WAIT] = "wait",
+    [TELEMETRY_RETRY] = "retry",
+    [TELEMETRY_ROUTINE] = "routine",
+    [TELEMETRY_ENGAGE] = "engage",
+    [TELEMETRY_TURN] = "turn",
+    [TELEMETRY_STALL] = "stall",
+    [TELEMETRY_RECOVERY] = "recovery",
+    [TELEMETRY_RECOVERED] = "recovered",
+};
+
+
+const char *telemetry_event_name(TelemetryEventType type) {
+    return type < TELEMETRY_EVENT_COUNT ? TELEMETRY_EVENT_NAMES[type] : "unknown";
+}
+
+
+bool telemetry_record(Telemetry *telemetry, TelemetryEventType type, int instance, int state, int detail,
+                      uint32_t value, uint64_t time_ms) {
+    if (telemetry == NULL) {
+        return true;
+    }
+
+    // Bounded queue with a sequence number per slot: a producer claims a position with one
+    // CAS, fills the slot and publishes it by bumping the slot's sequence
+    size_t position = atomic_load_explicit(&telemetry->enqueue_position, memory_order_relaxed);
+    TelemetrySlot *slot;
+    while (1) {
+        slot = &telemetry->slots[position & (TELEMETRY_CAPACITY - 1)];
+        size_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+        if (difference == 0) {
+            if (atomic_compare_exchange_weak_explicit(&telemetry->enqueue_position, &position, position + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        }
+        else if (difference < 0) {
+            // The flusher has not freed this slot yet: full
+            atomic_fetch_add_explicit(&telemetry->dropped, 1, memory_order_relaxed);
+            return false;
+        }
+        else {
+            position = atomic_load_explicit(&telemetry->enqueue_position, memory_order_relaxed);
+        }
+    }
+
+    TelemetryEvent event = {time_ms, value, (uint8_t)type, (int8_t)instance, (int8_t)state, (int8_t)detail};
+    slot->event = event;
+    atomic_store_explicit(&slot->sequence, position + 1, memory_order_release);
+    return true;
+}
+
+
+/**
+ * @brief Takes the oldest published event, flusher only
+ */
+static bool telemetry_take(Telemetry *telemetry, TelemetryEvent *event) {
+    size_t position = telemetry->dequeue_position;
+    TelemetrySlot *slot = &telemetry->slots[position & (TELEMETRY_CAPACITY - 1)];
+    if (atomic_load_explicit(&slot->sequence, memory_order_acquire) != position + 1) {
+        return false;
+    }
+    *event = slot->event;
+    telemetry->dequeue_position = position + 1;
+    atomic_store_explicit(&slot->sequence, position + TELEMETRY_CAPACITY, memory_order_release);
+    return true;
+}
+
+
+static void latency_add(TelemetryLatency *latency, uint32_t value) {
+    latency->samples[latency->next] = value;
+    latency->next = (latency->next + 1) % TELEMETRY_SAMPLES;
+    if (latency->count < TELEMETRY_SAMPLES) {
+        latency->count++;
+    }
+    latency->total++;
+}
+
+
+static int compare_samples(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+
+uint32_t telemetry_percentile(const TelemetryLatency *latency, int percentile) {
+    if (latency->count == 0) {
+        return 0;
+    }
+    uint32_t sorted[TELEMETRY_SAMPLES];
+    memcpy(sorted, latency->samples, (size_t)latency->count * sizeof(uint32_t));
+    qsort(sorted, (size_t)latency->count, sizeof(uint32_t), compare_samples);
+    int index = (latency->count * percentile + 99) / 100 - 1;
+    return sorted[index < 0 ? 0 : index];
+}
+
+
+static const char *telemetry_state_name(const Telemetry *telemetry, int state) {
+    return state >= 0 && state < telemetry->config->state_count ? telemetry->config->states[state].name : "unknown";
+}
+
+
+/**
+ * @brief Statistics and the CSV line of one event
+ */
+static void telemetry_consume(Telemetry *telemetry, const TelemetryEvent *event) {
+    if (telemetry->events++ == 0) {
+        telemetry->first_ms = event->time_ms;
+    }
+    if (event->time_ms > telemetry->last_ms) {
+        telemetry->last_ms = event->time_ms;
+    }
+
+    bool known_state = event->state >= 0 && event->state < MAX_STATES;
+    bool *fighting = event->instance >= 0 && event->instance < TELEMETRY_INSTANCES ? &telemetry->fighting[event->instance] : NULL;
+    switch ((TelemetryEventType)event->type) {
+        case TELEMETRY_PHASE:
+            // Won: from the battle to a victory screen, through unrecognized frames in between
+            if (fighting != NULL && known_state) {
+                if (*fighting && (telemetry->win_states & (1u << event->state)) != 0) {
+                    telemetry->fights++;
+                }
+                *fighting = event->state == telemetry->battle_state;
+            }
+            if (event->detail >= 0 && event->detail < MAX_STATES) {
+                latency_add(&telemetry->phases[event->detail], event->value);
+            }
+            break;
+        case TELEMETRY_WAIT:
+            if (known_state) {
+                latency_add(&telemetry->waits[event->state], event->value);
+            }
+            break;
+        case TELEMETRY_RETRY:
+            telemetry->retries++;
+            break;
+        case TELEMETRY_ROUTINE:
+            telemetry->routines++;
+            telemetry->routine_timeouts += event->value;
+            break;
+        case TELEMETRY_TURN:
+            telemetry->turns++;
+            break;
+        case TELEMETRY_ENGAGE:
+            if (event->detail >= 0 && event->detail < MAX_SPAWNS) {
+                if (event->value != 0) {
+                    telemetry->spawn_fights[event->detail]++;
+                }
+                else {
+                    telemetry->spawn_busy[event->detail]++;
+                }
+            }
+            break;
+        case TELEMETRY_STALL:
+            telemetry->stalls++;
+            // However the battle ends now (restart, reconnect), the recovery ended it
+            if (fighting != NULL) {
+                *fighting = false;
+            }
+            break;
+        case TELEMETRY_RECOVERY:
+            telemetry->recovery_steps++;
+            break;
+        case TELEMETRY_RECOVERED:
+            telemetry->recoveries++;
+            telemetry->downtime_ms += event->value;
+            break;
+        default:
+            break;
+    }
+
+    if (telemetry->csv != NULL) {
+        fprintf(telemetry->csv, "%llu,%d,%s,%s,%d,%lu\n", (unsigned long long)event->time_ms, event->instance,
+                telemetry_event_name((TelemetryEventType)event->type), telemetry_state_name(telemetry, event->state),
+                event->detail, (unsigned long)event->value);
+    }
+}
+
+
+static void write_latencies(const Telemetry *telemetry, FILE *file, const char *name, const TelemetryLatency *latencies) {
+    fprintf(file, "  \"%s\": {", name);
+    bool first = true;
+    for (int i = 0; i < telemetry->config->state_count; i++) {
+        const TelemetryLatency *latency = &latencies[i];
+        if (latency->total == 0) {
+            continue;
+        }
+        fprintf(file, "%s\n    \"%s\": {\"count\": %llu, \"p50\": %lu, \"p95\": %lu, \"p99\": %lu}", first ? "" : ",",
+                telemetry->config->states[i].name, (unsigned long long)latency->total,
+                (unsigned long)telemetry_percentile(latency, 50), (unsigned long)telemetry_percentile(latency, 95),
+                (unsigned long)telemetry_percentile(latency, 99));
+        first = false;
+    }
+    fprintf(file, "%s}", first ? "" : "\n  ");
+}
+
+
+/**
+ * @brief Rewrites the JSON summary: to a temporary file first, which then replaces the summary
+ * in one step, so readers see either the old or the new one, never half of it or none
+ */
+static void telemetry_write_summary(const Telemetry *telemetry) {
+    if (telemetry->summary_path == NULL) {
+        return;
+    }
+    size_t length = strlen(telemetry->summary_path);
+    char *temporary = malloc(length + 5);
+    if (temporary == NULL) {
+        return;
+    }
+    memcpy(temporary, telemetry->summary_path, length);
+    memcpy(temporary + length, ".tmp", 5);
+
+    FILE *file = fopen(temporary, "w");
+    if (file == NULL) {
+        free(temporary);
+        return;
+    }
+    uint64_t elapsed = telemetry->last_ms - telemetry->first_ms;
+    fprintf(file, "{\n  \"elapsed_ms\": %llu,\n  \"events\": %llu,\n  \"dropped\": %llu,\n",
+            (unsigned long long)elapsed, (unsigned long long)telemetry->events,
+            (unsigned long long)atomic_load(&((Telemetry *)telemetry)->dropped));
+    fprintf(file, "  \"fights\": %llu,\n  \"fights_per_hour\": %.1f,\n  \"turns\": %llu,\n  \"retries\": %llu,\n",
+            (unsigned long long)telemetry->fights, elapsed > 0 ? telemetry->fights * 3600000.0 / elapsed : 0.0,
+            (unsigned long long)telemetry->turns, (unsigned long long)telemetry->retries);
+    fprintf(file, "  \"trainings\": {\"count\": %llu, \"unsettled_steps\": %llu},\n",
+            (unsigned long long)telemetry->routines, (unsigned long long)telemetry->routine_timeouts);
+    // Fights per spawn object, when the mode rotates over several
+    int spawns = 0;
+    for (int i = 0; i < MAX_SPAWNS; i++) {
+        if (telemetry->spawn_fights[i] > 0 || telemetry->spawn_busy[i] > 0) {
+            spawns = i + 1;
+        }
+    }
+    fprintf(file, "  \"spawns\": [");
+    for (int i = 0; i < spawns; i++) {
+        fprintf(file, "%s\n    {\"fights\": %llu, \"fights_per_hour\": %.1f, \"on_cooldown\": %llu}", i > 0 ? "," : "",
+                (unsigned long long)telemetry->spawn_fights[i], elapsed > 0 ? telemetry->spawn_fights[i] * 3600000.0 / elapsed : 0.0,
+                (unsigned long long)telemetry->spawn_busy[i]);
+    }
+    fprintf(file, "%s],\n", spawns > 0 ? "\n  " : "");
+    fprintf(file, "  \"stalls\": {\"count\": %llu, \"recovered\": %llu, \"recovery_steps\": %llu, \"downtime_ms\": %llu},\n",
+            (unsigned long long)telemetry->stalls, (unsigned long long)telemetry->recoveries,
+            (unsigned long long)telemetry->recovery_steps, (unsigned long long)telemetry->downtime_ms);
+    write_latencies(telemetry, file, "phases", telemetry->phases);
+    fprintf(file, ",\n");
+    write_latencies(telemetry, file, "waits", telemetry->waits);
+    fprintf(file, "\n}\n");
+    fclose(file);
+
+#ifdef _WIN32
+    MoveFileExA(temporary, telemetry->summary_path, MOVEFILE_REPLACE_EXISTING);
+#else
+    rename(temporary, telemetry->summary_path);
+#endif
+    free(temporary);
+}
+
+
+static void telemetry_drain(Telemetry *telemetry) {
+    TelemetryEvent event;
+    while (telemetry_take(telemetry, &event)) {
+        telemetry_consume(telemetry, &event);
+    }
+    if (telemetry->csv != NULL) {
+        fflush(telemetry->csv);
+    }
+}
+
+
+#ifdef _WIN32
+static DWORD WINAPI telemetry_flusher(void *arg) {
+#else
+static void *telemetry_flusher(void *arg) {
+#endif
+    Telemetry *telemetry = arg;
+    uint64_t next_summary = system_now_ms() + TELEMETRY_SUMMARY_MS;
+    while (!atomic_load(&telemetry->stop)) {
+        system_sleep_ms(TELEMETRY_FLUSH_MS);
+        telemetry_drain(telemetry);
+        if (system_now_ms() >= next_summary) {
+            telemetry_write_summary(telemetry);
+            next_summary = system_now_ms() + TELEMETRY_SUMMARY_MS;
+        }
+    }
+    return 0;
+}
+
+
+Telemetry *telemetry_start(const GameConfig *config, const char *path_prefix) {
+    Telemetry *telemetry = calloc(1, sizeof(Telemetry));
+    TelemetrySlot *slots = calloc(TELEMETRY_CAPACITY, sizeof(TelemetrySlot));
+    if (telemetry == NULL || slots == NULL) {
+        printf("\nError: Failed to allocate the telemetry buffer.\n");
+        free(telemetry);
+        free(slots);
+        return NULL;
+    }
+    telemetry->config = config;
+    telemetry->slots = slots;
+    for (size_t i = 0; i < TELEMETRY_CAPACITY; i++) {
+        atomic_init(&slots[i].sequence, i);
+    }
+    atomic_init(&telemetry->enqueue_position, 0);
+    atomic_init(&telemetry->dropped, 0);
+    atomic_init(&telemetry->stop, false);
+    telemetry->battle_state = config_find_state(config, "battle");
+    // The victory screen, plain or with the golden line. A data file that can't tell the plain
+    // one from the world view counts every battle left for a known screen.
+    int victory = config_find_state(config, "victory"), ready = config_find_state(config, "ready_to_train");
+    if (victory != STATE_UNKNOWN) {
+        telemetry->win_states = 1u << victory | (ready != STATE_UNKNOWN ? 1u << ready : 0);
+    }
+    else {
+        telemetry->win_states = telemetry->battle_state != STATE_UNKNOWN ? ~(1u << telemetry->battle_state) : ~0u;
+    }
+
+    if (path_prefix != NULL) {
+        size_t length = strlen(path_prefix);
+        char *csv_path = malloc(length + 5);
+        telemetry->summary_path = malloc(length + 6);
+        if (csv_path != NULL && telemetry->summary_path != NULL) {
+            sprintf(csv_path, "%s.csv", path_prefix);
+            sprintf(telemetry->summary_path, "%s.json", path_prefix);
+            telemetry->csv = fopen(csv_path, "w");
+        }
+        free(csv_path);
+        if (telemetry->csv == NULL) {
+            printf("\nError: Failed to create telemetry files %s.csv/.json.\n", path_prefix);
+            telemetry_free(telemetry);
+            return NULL;
+        }
+        fprintf(telemetry->csv, "time_ms,instance,event,state,detail,value\n");
+    }
+
+#ifdef _WIN32
+    telemetry->thread = CreateThread(NULL, 0, telemetry_flusher, telemetry, 0, NULL);
+    bool started = telemetry->thread != NULL;
+#else
+    bool started = pthread_create(&telemetry->thread, NULL, telemetry_flusher, telemetry) == 0;
+#endif
+    if (!started) {
+        printf("\nError: Failed to start the telemetry thread.\n");
+        telemetry_free(telemetry);
+        return NULL;
+    }
+    telemetry->running = true;
+    return telemetry;
+}
+
+
+void telemetry_stop(Telemetry *telemetry) {
+    if (telemetry == NULL || !telemetry->running) {
+        return;
+    }
+    telemetry->running = false;
+    atomic_store(&telemetry->stop, true);
+#ifdef _WIN32
+    WaitForSingleObject(telemetry->thread, INFINITE);
+    CloseHandle(telemetry->thread);
+#else
+    pthread_join(telemetry->thread, NULL);
+#endif
+    telemetry_drain(telemetry);
+    telemetry_write_summary(telemetry);
+}
+
+
+void telemetry_free(Telemetry *telemetry) {
+    if (telemetry == NULL) {
+        return;
+    }
+    telemetry_stop(telemetry);
+    if (telemetry->csv != NULL) {
+        fclose(telemetry->csv);
+    }
+    free(telemetry->summary_path);
+    free(telemetry->slots);
+    free(telemetry);
+}
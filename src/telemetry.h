@@ -0,0 +1,145 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+#include "config.h"
+
+// Events the ring buffer holds (power of two). When it is full new events are dropped and counted.
+#define TELEMETRY_CAPACITY 65536
+
+// How often the flusher drains the buffer and rewrites the summary (ms, wall clock)
+#define TELEMETRY_FLUSH_MS 100
+#define TELEMETRY_SUMMARY_MS 5000
+
+// Most a telemetry_record() from the farm thread may cost on average (ns)
+#define TELEMETRY_RECORD_BUDGET_NS 1000
+
+// Latency percentiles are computed over the last this many samples of every phase
+#define TELEMETRY_SAMPLES 256
+
+// Game windows whose fights are told apart, as many as the scheduler runs
+#define TELEMETRY_INSTANCES 16
+
+typedef enum {
+    TELEMETRY_PHASE,    // state entered; detail = previous state, value = ms spent in it
+    TELEMETRY_PROBE,    // The set of matching signatures changed; value = bitmask
+    TELEMETRY_WAIT,     // Wait after an action finished; state = acted state, detail = 1 on timeout, value = ms
+    TELEMETRY_RETRY,    // Action repeated after its timeout; state = acted state
+    TELEMETRY_ROUTINE,  // Routine (training) finished; detail = routine, value = steps whose screen never settled
+    TELEMETRY_ENGAGE,   // Spawn object clicked; detail = spawn of the mode, value = 1 if a fight started, 0 if on cooldown
+    TELEMETRY_TURN,     // Ability used in battle; detail = ability rule of the mode, value = enemy HP percent
+    TELEMETRY_STALL,    // The watchdog found the client stuck in state; value = ms since the last progress
+    TELEMETRY_RECOVERY, // Recovery step taken; detail = RecoveryKind, value = ms since the last progress
+    TELEMETRY_RECOVERED,  // Progress after a stall; state = new state, detail = last RecoveryKind, value = downtime ms
+    TELEMETRY_EVENT_COUNT
+} TelemetryEventType;
+
+typedef struct {
+    uint64_t time_ms;   // Backend clock
+    uint32_t value;
+    uint8_t type;       // TelemetryEventType
+    int8_t instance;    // Game window
+    int8_t state;
+    int8_t detail;
+} TelemetryEvent;
+
+typedef struct {
+    atomic_size_t sequence;  // Slot handshake between the producers and the flusher
+    TelemetryEvent event;
+} TelemetrySlot;
+
+/**
+ * @brief Rolling latency samples of one phase
+ */
+typedef struct {
+    uint32_t samples[TELEMETRY_SAMPLES];
+    int count;          // Valid samples, up to TELEMETRY_SAMPLES
+    int next;           // Where the next sample goes
+    uint64_t total;     // Samples ever recorded
+} TelemetryLatency;
+
+/**
+ * @brief Event recorder. Producers (the farm loop) only write into a preallocated lock-free
+ * ring buffer; a background thread drains it into a CSV file and keeps the statistics,
+ * which it rewrites as a JSON summary.
+ */
+typedef struct {
+    const GameConfig *config;
+    TelemetrySlot *slots;
+    atomic_size_t enqueue_position;
+    size_t dequeue_position;  // Flusher only
+    atomic_uint_fast64_t dropped;
+    atomic_bool stop;
+    bool running;  // The flusher was started and not stopped yet
+#ifdef _WIN32
+    void *thread;  // HANDLE of the flusher
+#else
+    pthread_t thread;
+#endif
+
+    // Output, NULL to only keep the statistics
+    FILE *csv;
+    char *summary_path;
+
+    // Statistics, flusher only
+    int battle_state;
+    uint32_t win_states;  // Bit per state: battle -> one of them counts a fight
+    bool fighting[TELEMETRY_INSTANCES];  // In a battle that no stall interrupted, by game window
+    uint64_t first_ms;
+    uint64_t last_ms;
+    uint64_t events;
+    uint64_t fights;
+    uint64_t turns;
+    uint64_t retries;
+    uint64_t routines;
+    uint64_t routine_timeouts;
+    uint64_t spawn_fights[MAX_SPAWNS];  // By spawn of the mode, with ACTION_ENGAGE
+    uint64_t spawn_busy[MAX_SPAWNS];    // Clicks that found the spawn on cooldown
+    uint64_t stalls;
+    uint64_t recoveries;      // Stalls that ended
+    uint64_t recovery_steps;
+    uint64_t downtime_ms;     // Of the stalls that ended
+    TelemetryLatency phases[MAX_STATES];  // Time spent in each state
+    TelemetryLatency waits[MAX_STATES];   // Action -> next state (or settle), by acted state
+} Telemetry;
+
+/**
+ * @brief Allocates the buffer and starts the flusher
+ * @param path_prefix Writes <prefix>.csv (every event) and <prefix>.json (summary), NULL for no files
+ * @return NULL on failure (the error is printed)
+ */
+Telemetry *telemetry_start(const GameConfig *config, const char *path_prefix);
+
+/**
+ * @brief Stops the flusher after a final drain and summary. The statistics stay readable.
+ */
+void telemetry_stop(Telemetry *telemetry);
+
+/**
+ * @brief Stops the flusher if it still runs and frees everything
+ */
+void telemetry_free(Telemetry *telemetry);
+
+/**
+ * @brief Records an event from any thread without locking or allocating. Does nothing
+ * when telemetry is NULL.
+ * @return false if the buffer was full and the event was dropped
+ */
+bool telemetry_record(Telemetry *telemetry, TelemetryEventType type, int instance, int state, int detail,
+                      uint32_t value, uint64_t time_ms);
+
+/**
+ * @brief Percentile (0-100) of the rolling samples, 0 when there are none
+ */
+uint32_t telemetry_percentile(const TelemetryLatency *latency, int percentile);
+
+const char *telemetry_event_name(TelemetryEventType type);
+
+#endif
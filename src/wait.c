@@ -0,0 +1,72 @@
+#include <stdio.h>
+#include "wait.h"
+
+bool wait_verbose = true;
+
+
+void waiter_start(Waiter *waiter, uint64_t now_ms, unsigned timeout_ms) {
+    waiter->started_ms = now_ms;
+    waiter->deadline_ms = now_ms + timeout_ms;
+    waiter->poll_ms = WAIT_MIN_POLL_MS;
+    waiter->polls = 0;
+}
+
+
+unsigned waiter_next_delay(Waiter *waiter, uint64_t now_ms) {
+    if (now_ms >= waiter->deadline_ms) {
+        return 0;
+    }
+
+    unsigned delay = waiter->poll_ms;
+    uint64_t remaining = waiter->deadline_ms - now_ms;
+    if (delay > remaining) {
+        delay = (unsigned)remaining;
+    }
+    waiter->polls++;
+
+    // Back off by 1.5x: fast at first when the state usually appears, cheap on long waits
+    waiter->poll_ms += waiter->poll_ms / 2;
+    if (waiter->poll_ms > WAIT_MAX_POLL_MS) {
+        waiter->poll_ms = WAIT_MAX_POLL_MS;
+    }
+    return delay;
+}
+
+
+void waiter_cap(Waiter *waiter, unsigned poll_ms) {
+    if (waiter->poll_ms > poll_ms) {
+        waiter->poll_ms = poll_ms;
+    }
+}
+
+
+void settle_start(SettleTracker *tracker) {
+    SettleTracker empty = {0};
+    *tracker = empty;
+}
+
+
+bool settle_update(SettleTracker *tracker, uint64_t fingerprint, uint64_t now_ms, unsigned settle_ms) {
+    if (!tracker->has_reference) {
+        tracker->has_reference = true;
+        tracker->reference = fingerprint;
+        tracker->still_since = now_ms;
+    }
+    else if (fingerprint != tracker->reference) {
+        tracker->changed = true;
+        tracker->reference = fingerprint;
+        tracker->still_since = now_ms;
+    }
+    else if (tracker->changed && now_ms - tracker->still_since >= settle_ms) {
+        return true;
+    }
+    return false;
+}
+
+
+void wait_report(const char *what, WaitResult result) {
+    if (!wait_verbose) {
+        return;
+    }
+    printf("\n%s: %u ms, %d polls%s", what, result.elapsed_ms, result.polls, result.satisfied ? "" : " (timeout)");
+}
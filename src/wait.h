@@ -0,0 +1,69 @@
+#ifndef WAIT_H
+#define WAIT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "backend.h"
+#include "frame.h"
+
+// Adaptive polling: the first re-check comes quickly, then the interval grows up to the ceiling
+#define WAIT_MIN_POLL_MS 10
+#define WAIT_MAX_POLL_MS 200
+
+// Whether wait_report() prints anything (off for benchmarks)
+extern bool wait_verbose;
+
+typedef struct {
+    bool satisfied;       // false means the timeout expired
+    unsigned elapsed_ms;  // How long the wait actually took
+    int polls;            // Number of frames inspected
+} WaitResult;
+
+/**
+ * @brief Polling schedule of one wait, usable without blocking (see waiter_next_delay)
+ */
+typedef struct {
+    uint64_t started_ms;
+    uint64_t deadline_ms;
+    unsigned poll_ms;
+    int polls;            // Checks scheduled so far, one per delay handed out
+} Waiter;
+
+/**
+ * @brief Detects a screen that changed after an action and then stayed still
+ */
+typedef struct {
+    bool has_reference;
+    bool changed;
+    uint64_t reference;   // Fingerprint of the last distinct frame
+    uint64_t still_since;
+} SettleTracker;
+
+void settle_start(SettleTracker *tracker);
+
+/**
+ * @brief Feeds the fingerprint of a new frame
+ * @return true once the screen changed and then stayed the same for settle_ms
+ */
+bool settle_update(SettleTracker *tracker, uint64_t fingerprint, uint64_t now_ms, unsigned settle_ms);
+
+void waiter_start(Waiter *waiter, uint64_t now_ms, unsigned timeout_ms);
+
+/**
+ * @brief Returns how long to sleep before the next check, counts the check and backs the
+ * interval off
+ * @return 0 if the deadline has already passed
+ */
+unsigned waiter_next_delay(Waiter *waiter, uint64_t now_ms);
+
+/**
+ * @brief Caps the polling interval, e.g. while the screen is moving
+ */
+void waiter_cap(Waiter *waiter, unsigned poll_ms);
+
+/**
+ * @brief Prints how long a wait took and how many frames it looked at
+ */
+void wait_report(const char *what, WaitResult result);
+
+#endif
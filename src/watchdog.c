@@ -0,0 +1,114 @@
+#include "watchdog.h"
+
+static const char *RECOVERY_NAMES[RECOVERY_KIND_COUNT] = {
+    [RECOVERY_ESCAPE] = "escape",
+    [RECOVERY_CLOSE] = "close",
+    [RECOVERY_REANCHOR] = "reanchor",
+    [RECOVERY_HOME] = "home",
+    [RECOVERY_RESTART] = "restart",
+};
+
+
+const char *recovery_name(RecoveryKind kind) {
+    return kind < RECOVERY_KIND_COUNT ? RECOVERY_NAMES[kind] : "unknown";
+}
+
+
+static void watchdog_add(Watchdog *watchdog, RecoveryKind kind, CoordId target, unsigned wait_ms) {
+    RecoveryStep step = {kind, target, wait_ms};
+    watchdog->steps[watchdog->step_count++] = step;
+}
+
+
+void watchdog_init(Watchdog *watchdog, const GameConfig *config, bool can_restart, uint64_t now_ms) {
+    Watchdog empty = {0};
+    *watchdog = empty;
+    const WatchdogConfig *settings = &config->watchdog;
+    watchdog->stall_ms = settings->stall_ms;
+    watchdog->unknown_ms = settings->unknown_ms;
+    watchdog->known_state = STATE_UNKNOWN;
+    watchdog->progress_ms = now_ms;
+
+    watchdog_add(watchdog, RECOVERY_ESCAPE, 0, WATCHDOG_STEP_MS);
+    for (int i = 0; i < settings->close_count; i++) {
+        watchdog_add(watchdog, RECOVERY_CLOSE, settings->closes[i], WATCHDOG_STEP_MS);
+    }
+    watchdog_add(watchdog, RECOVERY_REANCHOR, 0, WATCHDOG_STEP_MS);
+    if (settings->home_routine >= 0) {
+        // The routine clicks through its steps first
+        const Routine *home = &config->routines[settings->home_routine];
+        unsigned wait_ms = WATCHDOG_STEP_MS;
+        for (int i = 0; i < home->step_count; i++) {
+            wait_ms += home->steps[i].timeout_ms;
+        }
+        watchdog_add(watchdog, RECOVERY_HOME, 0, wait_ms);
+    }
+    if (can_restart) {
+        watchdog_add(watchdog, RECOVERY_RESTART, 0, settings->restart_ms + WATCHDOG_STEP_MS);
+    }
+}
+
+
+unsigned watchdog_limit(const Watchdog *watchdog, int state) {
+    if (state < 0 || state >= MAX_STATES || watchdog->samples[state] < WATCHDOG_LEARN_SAMPLES) {
+        return watchdog->stall_ms;
+    }
+    uint64_t limit = (uint64_t)watchdog->longest_ms[state] * WATCHDOG_LEARN_FACTOR;
+    if (limit < WATCHDOG_MIN_STALL_MS) {
+        limit = WATCHDOG_MIN_STALL_MS;
+    }
+    return limit < watchdog->stall_ms ? (unsigned)limit : watchdog->stall_ms;
+}
+
+
+const RecoveryStep *watchdog_update(Watchdog *watchdog, int state, int progress, uint64_t now_ms) {
+    // Leaving the screen the client was stuck on counts too, even back to the last known one
+    bool progressed = progress != watchdog->progress || (state != STATE_UNKNOWN && state != watchdog->known_state) ||
+                      (watchdog->stalled && state != STATE_UNKNOWN && state != watchdog->stuck_state);
+    int previous = watchdog->known_state;
+    watchdog->progress = progress;
+    if (state != STATE_UNKNOWN) {
+        watchdog->known_state = state;
+    }
+
+    if (progressed) {
+        if (watchdog->stalled) {
+            watchdog->stalled = false;
+            watchdog->recovered++;
+            watchdog->recovered_by[watchdog->last_kind]++;
+            watchdog->downtime_ms += now_ms - watchdog->progress_ms;
+        }
+        // The wait on the state the client was on, a normal one as it ended without help
+        else if (previous != STATE_UNKNOWN && previous < MAX_STATES) {
+            unsigned waited = (unsigned)(now_ms - watchdog->progress_ms);
+            if (waited > watchdog->longest_ms[previous]) {
+                watchdog->longest_ms[previous] = waited;
+            }
+            watchdog->samples[previous]++;
+        }
+        watchdog->progress_ms = now_ms;
+        return NULL;
+    }
+
+    if (!watchdog->stalled) {
+        unsigned limit = state == STATE_UNKNOWN ? watchdog->unknown_ms : watchdog_limit(watchdog, state);
+        if (watchdog->stall_ms == 0 || now_ms - watchdog->progress_ms < limit) {
+            return NULL;
+        }
+        watchdog->stalled = true;
+        watchdog->stuck_state = state;
+        watchdog->next_step = 0;
+        watchdog->incidents++;
+    }
+    else if (now_ms < watchdog->step_until) {
+        return NULL;
+    }
+
+    // The next step of the playbook, from the first one again after the last
+    const RecoveryStep *step = &watchdog->steps[watchdog->next_step];
+    watchdog->next_step = (watchdog->next_step + 1) % watchdog->step_count;
+    watchdog->step_until = now_ms + step->wait_ms;
+    watchdog->last_kind = step->kind;
+    watchdog->steps_taken++;
+    return step;
+}
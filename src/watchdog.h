@@ -0,0 +1,97 @@
+#ifndef WATCHDOG_H
+#define WATCHDOG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "config.h"
+
+// After every recovery step the bot gets this long to make progress before the next one (ms)
+#define WATCHDOG_STEP_MS 5000
+
+// The screen gets this long to follow a recovery step before the bot looks at it again (ms)
+#define WATCHDOG_SETTLE_MS 1000
+
+// A state's stall limit is learned once the client made progress on it this many times
+#define WATCHDOG_LEARN_SAMPLES 10
+
+// The learned limit: this many times the longest wait for progress seen on the state,
+// at least WATCHDOG_MIN_STALL_MS and at most the stall_ms of the data file
+#define WATCHDOG_LEARN_FACTOR 4
+#define WATCHDOG_MIN_STALL_MS 20000
+
+// Escape, every close button, re-anchoring, the home routine and the restart
+#define WATCHDOG_MAX_STEPS (MAX_CLOSE_BUTTONS + 4)
+
+/**
+ * @brief Recovery steps, from the cheapest to the most drastic
+ */
+typedef enum {
+    RECOVERY_ESCAPE,    // Focus the game window and press Esc
+    RECOVERY_CLOSE,     // Click a close button of the data file
+    RECOVERY_REANCHOR,  // Find the window and the game in it again
+    RECOVERY_HOME,      // Run the home routine back to the world view
+    RECOVERY_RESTART,   // Restart the game client through the restart hook
+    RECOVERY_KIND_COUNT
+} RecoveryKind;
+
+typedef struct {
+    RecoveryKind kind;
+    CoordId target;    // RECOVERY_CLOSE: button to click
+    unsigned wait_ms;  // Time given to the step before the next one
+} RecoveryStep;
+
+/**
+ * @brief Stall detector and recovery playbook of one game client. Progress is a newly
+ * recognized screen or an action of the bot that had its effect; without any for longer
+ * than the limit of the screen the client is on, it is stuck and the playbook runs one step
+ * at a time until progress resumes, starting over after the last step. The limit of a screen
+ * is the stall_ms of the data file until the watchdog has seen how long progress takes there.
+ */
+typedef struct {
+    unsigned stall_ms;
+    unsigned unknown_ms;
+    unsigned longest_ms[MAX_STATES];  // Longest wait for progress seen on every state, stalls aside
+    int samples[MAX_STATES];          // Waits seen on every state
+    RecoveryStep steps[WATCHDOG_MAX_STEPS];
+    int step_count;
+
+    int known_state;        // Last recognized state
+    int progress;           // Progress counter of the bot at the last look
+    uint64_t progress_ms;   // Time of the last progress
+
+    // Incident in progress
+    bool stalled;
+    int stuck_state;
+    int next_step;
+    uint64_t step_until;    // The current step has until then
+    RecoveryKind last_kind; // Of the step taken last
+
+    // Totals
+    int incidents;
+    int recovered;
+    int steps_taken;
+    uint64_t downtime_ms;   // From the last progress before every stall to the progress that ended it
+    int recovered_by[RECOVERY_KIND_COUNT];  // Incidents ended by each kind of step
+} Watchdog;
+
+/**
+ * @brief Builds the playbook from the data file
+ * @param can_restart Whether a restart hook is there to run
+ */
+void watchdog_init(Watchdog *watchdog, const GameConfig *config, bool can_restart, uint64_t now_ms);
+
+/**
+ * @brief Looks at the client after a turn of its bot
+ * @param progress Counter the bot raises whenever an action had its effect
+ * @return The recovery step to take now, NULL if none is due
+ */
+const RecoveryStep *watchdog_update(Watchdog *watchdog, int state, int progress, uint64_t now_ms);
+
+/**
+ * @brief How long the client may go without progress on a recognized state before it is stuck
+ */
+unsigned watchdog_limit(const Watchdog *watchdog, int state);
+
+const char *recovery_name(RecoveryKind kind);
+
+#endif
@@ -0,0 +1,124 @@
+#include <stdio.h>
+#include <string.h>
+#include "tests.h"
+
+
+/**
+ * @brief Reads health bars drawn at every percent into synthetic battle frames of two sizes,
+ * with the HP printed over the bar, and the turn pixel lit and dimmed. Then farms fights
+ * of several turns on the simulated client: clicking the ability and waiting for the victory
+ * screen, fighting turn by turn, fighting with a finisher for low enemy HP, and fighting with
+ * no rule for the HP read, which must fall back to the first ability.
+ * @return Number of failed checks
+ */
+int test_battle(double hours) {
+    static Scheduler scheduler;
+    static GameConfig fighting;
+    int checks = 0, failures = 0, worst = 0;
+    const HpBar *bar = &test_config.hp_bars[HP_ENEMY];
+    static const GameArea areas[] = {{0, 0, BASE_SCREEN_WIDTH, BASE_SCREEN_HEIGHT, 0}, {171, 96, 1024, 576, 0}};
+    ScreenMetrics screen = {BASE_SCREEN_WIDTH, BASE_SCREEN_HEIGHT};
+    Frame frame = {0};
+    CoordTable coords = {0};
+    if (!bar->defined || !test_config.has_turn || !frame_reserve(&frame, BASE_SCREEN_WIDTH, BASE_SCREEN_HEIGHT)) {
+        printf("\nBattle: the data file defines no enemy health bar or turn pixel");
+        frame_free(&frame);
+        return 1;
+    }
+    RGBColor background = {34, 30, 52}, empty = {48, 40, 40}, text = {250, 250, 250}, dimmed = {90, 90, 96};
+    for (int a = 0; a < 2; a++) {
+        coord_table_build(&coords, screen, areas[a]);
+        int x0 = areas[a].x + (int)(bar->x * coords.scale_x), x1 = areas[a].x + (int)((bar->x + bar->width) * coords.scale_x);
+        int y0 = areas[a].y + (int)(bar->y * coords.scale_y), y1 = areas[a].y + (int)((bar->y + bar->height) * coords.scale_y);
+        for (int percent = 0; percent <= 100; percent++) {
+            frame_fill(&frame, 0, 0, frame.width, frame.height, background);
+            frame_fill(&frame, x0, y0, x1 - x0, y1 - y0, empty);
+            frame_fill(&frame, x0, y0, (x1 - x0) * percent / 100, y1 - y0, bar->color);
+            // "123/200" over the middle of the bar
+            frame_fill(&frame, (x0 + x1) / 2 - (x1 - x0) * 3 / 100, y0 + 2, (x1 - x0) * 6 / 100, y1 - y0 - 4, text);
+            int read = battle_read_hp(&frame, &coords, bar);
+            int error = read > percent ? read - percent : percent - read;
+            worst = error > worst ? error : worst;
+            checks++;
+            failures += error > BATTLE_HP_GAP_PERCENT / 2;
+        }
+        Point turn = coord_screen(&coords, test_config.turn.coord);
+        frame_set(&frame, turn.x, turn.y, test_config.turn.color);
+        checks++;
+        failures += !battle_player_turn(&test_config, &coords, &frame);
+        frame_set(&frame, turn.x, turn.y, dimmed);
+        checks++;
+        failures += battle_player_turn(&test_config, &coords, &frame);
+    }
+    frame_free(&frame);
+
+    // A finisher at 30% of the enemy's HP, the strongest ability while the player has at least
+    // half of its own, a weaker one otherwise
+    GameMode rules = {0};
+    AbilityRule finisher = {COORD_TRAIN_SLOT, 30, 0}, strongest = {COORD_ABILITY, 100, 50}, weaker = {COORD_START_FIGHT, 100, 0};
+    rules.abilities[0] = finisher;
+    rules.abilities[1] = strongest;
+    rules.abilities[2] = weaker;
+    rules.ability_count = 3;
+    static const BattleView views[] = {{100, 100, true}, {31, 100, true}, {30, 100, true}, {80, 49, true}, {-1, -1, true}};
+    static const int chosen[] = {1, 1, 0, 2, 0};
+    for (int i = 0; i < 5; i++) {
+        checks++;
+        failures += battle_choose(&rules, &views[i]) != chosen[i];
+    }
+    printf("\nBattle: health bars read within %d%% at 0-100%% in 2 window sizes, %d/%d synthetic frame checks passed",
+           worst, checks - failures, checks);
+
+    // The simulated enemy takes 30% a hit, or all it has left from a finisher once it is down to 40%
+    SimulatorConfig sim_config;
+    simulator_default_config(&sim_config);
+    Point finisher_slot = {514, 680};
+    sim_config.abilities[0].damage = 30;
+    sim_config.abilities[1].position = finisher_slot;
+    sim_config.abilities[1].damage = 10;
+    sim_config.abilities[1].finisher_hp = 40;
+    sim_config.ability_count = 2;
+
+    fighting = test_config;
+    int battle = config_find_state(&fighting, "battle");
+    if (battle == STATE_UNKNOWN || fighting.point_count >= COORD_CUSTOM_MAX) {
+        return failures + 1;
+    }
+    snprintf(fighting.point_names[fighting.point_count], CONFIG_NAME_LENGTH, "ability_finisher");
+    fighting.points[fighting.point_count] = finisher_slot;
+    CoordId finisher_coord = (CoordId)(COORD_COUNT + fighting.point_count++);
+    GameMode *mode = &fighting.modes[0];
+    unsigned timeout_ms = mode->actions[battle].timeout_ms;
+    double fights_per_hour[4], turns_per_fight[4];
+    static const char *names[] = {"click and wait", "turn by turn", "with finisher", "no rule fits"};
+    printf("\nBattle, fights of 4 turns (3 with the finisher), %s:", test_config.modes[0].title);
+    for (int pass = 0; pass < 4; pass++) {
+        // The last pass has only a rule for the enemy's last 10%: the first ability is used until then
+        AbilityRule ability = {COORD_ABILITY, pass == 3 ? 10 : 100, 0}, finish = {finisher_coord, 40, 0};
+        mode->ability_count = 0;
+        if (pass == 2) {
+            mode->abilities[mode->ability_count++] = finish;
+        }
+        mode->abilities[mode->ability_count++] = ability;
+        Action click = {ACTION_CLICK, COORD_ABILITY, timeout_ms, -1}, fight = {ACTION_FIGHT, 0, timeout_ms, -1};
+        mode->actions[battle] = pass == 0 ? click : fight;
+
+        Backend *backend = test_start(&scheduler, &sim_config, &fighting, mode);
+        if (backend == NULL) {
+            return failures + 1;
+        }
+        test_run(&scheduler, hours);
+        SimulatorStats stats = simulator_stats(backend);
+        fights_per_hour[pass] = test_fights_per_hour(&stats);
+        turns_per_fight[pass] = stats.fights > 0 ? (double)stats.turns / stats.fights : 0.0;
+        printf("\n  %-15s fights/hour: %6.1f  turns per fight: %4.2f  idle per cycle: %6.0f ms  missed clicks: %d",
+               names[pass], fights_per_hour[pass], turns_per_fight[pass],
+               stats.fights > 0 ? (double)stats.idle_ms / stats.fights : 0.0, stats.missed_clicks);
+        test_stop(&scheduler, backend);
+    }
+    checks++;
+    failures += fights_per_hour[1] <= fights_per_hour[0] || fights_per_hour[2] <= fights_per_hour[1] ||
+                turns_per_fight[2] >= turns_per_fight[1] || fights_per_hour[3] < fights_per_hour[1];
+    printf("\n  %d/%d checks passed", checks - failures, checks);
+    return failures;
+}
@@ -0,0 +1,115 @@
+#include <stdio.h>
+#include "capture.h"
+#include "coords.h"
+#include "tests.h"
+
+
+// The file backend behind the capture thread check, which stamps the number of every
+// capture into the first and last pixel: a held frame that changes, or one mixed from
+// two captures, shows in the stamps
+static Backend *stamped_file = NULL;
+static uint32_t stamped_count = 0;
+static uint64_t stamped_us = 0;
+
+static bool stamped_capture(Backend *self, int x, int y, int width, int height, Frame *frame) {
+    (void)self;
+    uint64_t started = system_now_us();
+    if (!stamped_file->capture(stamped_file, x, y, width, height, frame)) {
+        return false;
+    }
+    stamped_count++;
+    frame->pixels[0] = stamped_count;
+    frame->pixels[(size_t)(frame->height - 1) * frame->stride + frame->width - 1] = stamped_count;
+    stamped_us += system_now_us() - started;
+    return true;
+}
+
+
+/**
+ * @brief Stress test of the capture thread on a framebuffer file: the reader takes the newest
+ * frame and holds it for 0-3 ms at random while the thread captures as fast as it is told.
+ * Checks that the frames come in order, stay untouched while held and are never torn, and
+ * that every capture was either taken, dropped or is still waiting.
+ * @return Number of failed checks
+ */
+int test_capture_thread(unsigned interval_ms, unsigned duration_ms) {
+    const char *path = "capture-check.raw";
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) {
+        printf("\nError: Failed to create %s.\n", path);
+        return 1;
+    }
+    uint32_t seed = 4242;
+    for (int i = 0; i < BASE_SCREEN_WIDTH * BASE_SCREEN_HEIGHT; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        uint32_t pixel = 0xFF000000u | (seed >> 8);
+        fwrite(&pixel, sizeof(pixel), 1, file);
+    }
+    fclose(file);
+
+    stamped_file = backend_file_create(path, BASE_SCREEN_WIDTH, BASE_SCREEN_HEIGHT);
+    if (stamped_file == NULL) {
+        remove(path);
+        return 1;
+    }
+    Backend stamped = *stamped_file;
+    stamped.capture = stamped_capture;
+    stamped_count = 0;
+    stamped_us = 0;
+
+    CaptureThread capture;
+    GameArea area = {171, 96, 1024, 576, 0};
+    if (!capture_thread_start(&capture, &stamped, area, interval_ms)) {
+        backend_destroy(stamped_file);
+        remove(path);
+        return 1;
+    }
+
+    int checks = 0, failures = 0;
+    uint64_t last_sequence = 0, age_total = 0, age_max = 0, handoff_us = 0, calls = 0;
+    uint64_t until = system_now_ms() + duration_ms;
+    while (system_now_ms() < until) {
+        bool fresh;
+        uint64_t started = system_now_us();
+        const Frame *frame = capture_thread_latest(&capture, &fresh);
+        handoff_us += system_now_us() - started;
+        calls++;
+
+        seed = seed * 1664525u + 1013904223u;
+        unsigned hold = (seed >> 16) % 4;
+        if (frame == NULL || !fresh) {
+            system_sleep_ms(hold);
+            continue;
+        }
+        uint64_t age = system_now_ms() - frame->time_ms;
+        age_total += age;
+        age_max = age > age_max ? age : age_max;
+
+        const uint32_t *last = frame->pixels + (size_t)(frame->height - 1) * frame->stride + frame->width - 1;
+        uint32_t stamp = frame->pixels[0];
+        checks++;
+        failures += frame->sequence <= last_sequence || stamp != (uint32_t)frame->sequence || *last != stamp;
+        last_sequence = frame->sequence;
+
+        system_sleep_ms(hold);
+        checks++;
+        failures += frame->sequence != last_sequence || frame->pixels[0] != stamp || *last != stamp;
+    }
+    capture_thread_stop(&capture);
+
+    uint64_t captured = atomic_load(&capture.captured), dropped = atomic_load(&capture.dropped);
+    bool waiting = (atomic_load(&capture.published) & CAPTURE_FRESH) != 0;
+    checks++;
+    failures += captured != capture.taken + dropped + waiting || captured != stamped_count || atomic_load(&capture.failed) != 0;
+
+    printf("\nCapture thread, file backend, every %2u ms: %5.0f captures/s  taken: %5llu  dropped: %5llu"
+           "  age avg/max: %4.1f/%2llu ms  handoff: %5.3f us vs capture: %5.0f us  %d/%d checks passed",
+           interval_ms, captured * 1000.0 / duration_ms, (unsigned long long)capture.taken, (unsigned long long)dropped,
+           capture.taken > 0 ? (double)age_total / capture.taken : 0.0, (unsigned long long)age_max,
+           calls > 0 ? (double)handoff_us / calls : 0.0, captured > 0 ? (double)stamped_us / captured : 0.0,
+           checks - failures, checks);
+    backend_destroy(stamped_file);
+    stamped_file = NULL;
+    remove(path);
+    return failures;
+}
@@ -0,0 +1,46 @@
+#include <stdio.h>
+#include "tests.h"
+
+
+/**
+ * @brief Farms every mode of the data file shipped for the real client on the simulated one.
+ * Only its known pixels (battle, golden line, popups) match the simulator, everything else
+ * is seen as the world view, like the screens of the real client it has no signature for.
+ * Every mode must win fights, the training modes must train, and nothing may stall.
+ * @return Number of failed checks
+ */
+int test_shipped_config(const char *path, double hours) {
+    static GameConfig shipped;
+    static Scheduler scheduler;
+    if (!config_load(&shipped, path)) {
+        return 1;
+    }
+
+    int checks = 0, failures = 0;
+    printf("\nShipped data file %s on the simulated client, %.1f h per mode:", path, hours);
+    for (int i = 0; i < shipped.mode_count; i++) {
+        const GameMode *mode = &shipped.modes[i];
+        SimulatorConfig sim_config;
+        simulator_default_config(&sim_config);
+        Backend *backend = test_start(&scheduler, &sim_config, &shipped, mode);
+        if (backend == NULL) {
+            return failures + 1;
+        }
+        test_run(&scheduler, hours);
+        SimulatorStats stats = simulator_stats(backend);
+        int stalls = scheduler.instances[0].watchdog.incidents;
+        printf("\n  %-34s fights/hour: %6.1f  trainings: %3d  missed clicks: %4d  stalls: %d", mode->title,
+               test_fights_per_hour(&stats), stats.trainings, stats.missed_clicks, stalls);
+        // A training mode runs a routine once the golden line shows
+        bool trains = false;
+        int ready = config_find_state(&shipped, "ready_to_train");
+        if (ready != STATE_UNKNOWN) {
+            trains = mode->actions[ready].routine >= 0;
+        }
+        checks++;
+        failures += stats.fights == 0 || (trains && stats.trainings == 0) || (!trains && stats.trainings != 0) || stalls != 0;
+        test_stop(&scheduler, backend);
+    }
+    printf("\n  %d/%d checks passed", checks - failures, checks);
+    return failures;
+}
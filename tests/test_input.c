@@ -0,0 +1,95 @@
+#include <stdio.h>
+#include "input.h"
+#include "tests.h"
+
+
+/**
+ * @brief Whether the events logged from first on are exactly the expected ones
+ */
+static bool logged(const FakeScreen *log, int first, const InputEvent *expected, int count) {
+    if (log->count - first != count) {
+        return false;
+    }
+    for (int i = 0; i < count; i++) {
+        const InputEvent *event = &log->events[first + i];
+        if (event->type != expected[i].type || event->x != expected[i].x || event->y != expected[i].y ||
+            event->hold_ms != expected[i].hold_ms) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/**
+ * @brief Submits sequences to a backend that logs them and checks the events, their order,
+ * the holds and the time from the first event to the release: a click, a click on the same
+ * target (which must hover as long again), merged moves, Esc, and one backend call per sequence.
+ * @return Number of failed checks
+ */
+int test_input(void) {
+    // A screen that only takes input
+    ScreenMetrics screen = {BASE_SCREEN_WIDTH, BASE_SCREEN_HEIGHT};
+    Backend *backend = test_fake_create(screen, NULL, NULL);
+    if (backend == NULL) {
+        return 1;
+    }
+    FakeScreen *log = backend->ctx;
+    const InputHolds *holds = &input_holds;
+    InputSequence sequence = {0};
+    Point target = {20000, 30000}, other = {40000, 10000};
+    int checks = 0, failures = 0;
+
+    // A click: onto the target, hover, press, release
+    for (int pass = 0; pass < 2; pass++) {
+        int first = log->count, sends = log->sends;
+        input_begin(&sequence);
+        input_click(&sequence, target);
+        input_submit(backend, &sequence);
+        const InputEvent click[] = {{INPUT_EVENT_MOVE, target.x, target.y, holds->move_hold},
+                                    {INPUT_EVENT_PRESS, 0, 0, holds->press_hold},
+                                    {INPUT_EVENT_RELEASE, 0, 0, holds->release_hold}};
+        checks++;
+        failures += !logged(log, first, click, 3) || log->sends != sends + 1;
+        // The release comes after the hover and the press, the second time too
+        checks++;
+        failures += log->count != first + 3 ||
+                    log->delivered_ms[first + 2] - log->delivered_ms[first] != holds->move_hold + holds->press_hold;
+    }
+
+    // Moves nothing happened between end up as the last one
+    int first = log->count;
+    input_begin(&sequence);
+    input_move(&sequence, other, 5);
+    input_move(&sequence, target, 10);
+    input_press(&sequence, holds->press_hold);
+    input_release(&sequence, holds->release_hold);
+    input_submit(backend, &sequence);
+    const InputEvent merged[] = {{INPUT_EVENT_MOVE, target.x, target.y, 10},
+                                 {INPUT_EVENT_PRESS, 0, 0, holds->press_hold},
+                                 {INPUT_EVENT_RELEASE, 0, 0, holds->release_hold}};
+    checks++;
+    failures += !logged(log, first, merged, 3);
+
+    // Esc: down, up, the pointer left where it was
+    first = log->count;
+    input_begin(&sequence);
+    input_key(&sequence, INPUT_KEY_ESCAPE);
+    input_submit(backend, &sequence);
+    const InputEvent escape[] = {{INPUT_EVENT_KEY_DOWN, INPUT_KEY_ESCAPE, 0, holds->press_hold},
+                                 {INPUT_EVENT_KEY_UP, INPUT_KEY_ESCAPE, 0, holds->release_hold}};
+    checks++;
+    failures += !logged(log, first, escape, 2);
+
+    // Nothing queued, nothing sent
+    int sends = log->sends;
+    input_begin(&sequence);
+    input_submit(backend, &sequence);
+    checks++;
+    failures += log->sends != sends;
+
+    printf("\nInput: %d events in %d backend calls, click to release %u ms  %d/%d checks passed", log->count, log->sends,
+           holds->move_hold + holds->press_hold, checks - failures, checks);
+    backend_destroy(backend);
+    return failures;
+}
@@ -0,0 +1,121 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tests.h"
+
+#define TEST_LOCATOR_TRIALS 20
+// Farthest a located window corner may be off, in base pixels: well inside any button
+#define TEST_LOCATOR_MAX_ERROR 10.0
+
+
+/**
+ * @brief How far the located area is off the window, in base pixels: the worst of its corners
+ */
+static double area_error(const GameArea *area, const SimulatorConfig *sim_config, double scale) {
+    int error = abs(area->x - sim_config->window_x);
+    int top = abs(area->y - sim_config->window_y);
+    int right = abs(area->x + area->width - sim_config->window_x - sim_config->window_width);
+    int bottom = abs(area->y + area->height - sim_config->window_y - sim_config->window_height);
+    if (top > error) error = top;
+    if (right > error) error = right;
+    if (bottom > error) error = bottom;
+    return error / scale;
+}
+
+
+/**
+ * @brief Places the simulated game window at random offsets and scales and checks that the
+ * locator finds it, within a few base pixels, in the whole screen and in a capture that starts
+ * elsewhere than the screen's origin. Then checks that it finds nothing on a screen without
+ * the game, keeps the last area while the anchor is gone, and searches again only after
+ * LOCATOR_RETRY_MS.
+ * @return Number of failed checks
+ */
+int test_locator(void) {
+    Frame frame = {0}, part = {0};
+    int checks = 0, failures = 0, found = 0;
+    double worst_error = 0.0;
+    srand(7);
+    for (int i = 0; i < TEST_LOCATOR_TRIALS; i++) {
+        SimulatorConfig sim_config;
+        simulator_default_config(&sim_config);
+        double scale = 0.4 + 0.6 * rand() / RAND_MAX;
+        sim_config.window_width = (int)(BASE_SCREEN_WIDTH * scale);
+        sim_config.window_height = (int)(BASE_SCREEN_HEIGHT * scale);
+        sim_config.window_x = rand() % (sim_config.screen_width - sim_config.window_width + 1);
+        sim_config.window_y = rand() % (sim_config.screen_height - sim_config.window_height + 1);
+
+        Backend *sim = simulator_create(&sim_config);
+        checks++;
+        if (sim == NULL || !backend_snapshot(sim, &frame)) {
+            backend_destroy(sim);
+            failures++;
+            continue;
+        }
+        Locator trial;
+        locator_init(&trial, &test_anchor);
+        bool located = locator_search(&trial, &frame);
+        double error = located ? area_error(&trial.area, &sim_config, scale) : 0.0;
+        found += located;
+        worst_error = error > worst_error ? error : worst_error;
+        failures += !located || error > TEST_LOCATOR_MAX_ERROR;
+
+        // A capture of the window with a margin, its first pixel somewhere on the screen
+        int x = sim_config.window_x > 20 ? sim_config.window_x - 20 : 0;
+        int y = sim_config.window_y > 20 ? sim_config.window_y - 20 : 0;
+        locator_reset(&trial);
+        checks++;
+        located = sim->capture(sim, x, y, sim_config.window_width + 40, sim_config.window_height + 40, &part) &&
+                  locator_search(&trial, &part);
+        failures += !located || area_error(&trial.area, &sim_config, scale) > TEST_LOCATOR_MAX_ERROR;
+        locator_free(&trial);
+        backend_destroy(sim);
+    }
+
+    // A screen without the game: nothing found, and the area of a window that went away is
+    // kept until the next search is due
+    SimulatorConfig sim_config;
+    simulator_default_config(&sim_config);
+    Backend *sim = simulator_create(&sim_config);
+    Locator locator;
+    locator_init(&locator, &test_anchor);
+    if (sim == NULL || !backend_snapshot(sim, &frame) || !frame_reserve(&part, frame.width, frame.height)) {
+        backend_destroy(sim);
+        frame_free(&frame);
+        frame_free(&part);
+        return failures + 1;
+    }
+    RGBColor desktop = {20, 60, 90};
+    part.x = frame.x;
+    part.y = frame.y;
+    frame_fill(&part, part.x, part.y, part.width, part.height, desktop);
+    checks++;
+    failures += locator_search(&locator, &part);
+
+    // Found on the first update, then gone: searched for at once, again only after the retry time
+    uint64_t now = 1000;
+    GameArea area = locator_update(&locator, &frame, now);
+    int searches = locator.searches;
+    GameArea kept = locator_update(&locator, &part, now + 1);
+    bool same = memcmp(&area, &kept, sizeof(area)) == 0;
+    int failed_search = locator.searches - searches;
+    kept = locator_update(&locator, &part, now + LOCATOR_RETRY_MS);
+    same = same && memcmp(&area, &kept, sizeof(area)) == 0;
+    int waited = locator.searches - searches;
+    locator_update(&locator, &part, now + 1 + LOCATOR_RETRY_MS);
+    int retried = locator.searches - searches;
+    checks++;
+    failures += !same || failed_search != 1 || waited != 1 || retried != 2;
+    // Back: the cached area passes the verify-probe without a search
+    kept = locator_update(&locator, &frame, now + 2 + LOCATOR_RETRY_MS);
+    checks++;
+    failures += memcmp(&area, &kept, sizeof(area)) != 0 || locator.searches - searches != 2;
+
+    printf("\nWindow locator: %d/%d windows found at random offsets and scales, worst error %.1f base px"
+           "  %d/%d checks passed", found, TEST_LOCATOR_TRIALS, worst_error, checks - failures, checks);
+    locator_free(&locator);
+    backend_destroy(sim);
+    frame_free(&frame);
+    frame_free(&part);
+    return failures;
+}
@@ -0,0 +1,127 @@
+#include <stdio.h>
+#include <string.h>
+#include "match.h"
+#include "tests.h"
+
+// A small frame somewhere on the screen: 37 columns leave a tail after the 8- and 4-pixel blocks
+#define TEST_MATCH_X 100
+#define TEST_MATCH_Y 50
+#define TEST_MATCH_WIDTH 37
+#define TEST_MATCH_HEIGHT 6
+#define TEST_MATCH_TOLERANCE 10
+
+
+static uint32_t pixel(int alpha, int r, int g, int b) {
+    return (uint32_t)alpha << 24 | (uint32_t)r << 16 | (uint32_t)g << 8 | (uint32_t)b;
+}
+
+
+/**
+ * @brief Columns of the pattern rows that match at the test tolerance in [first, first + count)
+ */
+static int pattern_matches(int first, int count) {
+    int matches = 0;
+    for (int c = first; c < first + count && c < TEST_MATCH_WIDTH; c++) {
+        matches += c >= 0 && c % 3 == 0;
+    }
+    return matches;
+}
+
+
+/**
+ * @brief Rows 0 and 3 repeat a pattern: a pixel off by exactly the tolerance in one or more
+ * channels, one off by one more, and the background. Row 1 is the color itself with another
+ * alpha, the rest is background.
+ */
+static void paint_pattern(Frame *frame, RGBColor color) {
+    static const int at[6][3] = {{10, 10, 10}, {-10, -10, -10}, {10, -10, 0}, {0, 10, -10}, {-10, 0, 10}, {10, 10, -10}};
+    static const int past[6][3] = {{11, 0, 0}, {-11, 0, 0}, {0, 11, 0}, {0, -11, 0}, {0, 0, 11}, {10, 10, -11}};
+    for (int row = 0; row < TEST_MATCH_HEIGHT; row++) {
+        uint32_t *line = frame->pixels + (size_t)row * frame->stride;
+        for (int c = 0; c < TEST_MATCH_WIDTH; c++) {
+            line[c] = pixel(0xFF, 0, 0, 0);
+            if (row == 1) {
+                line[c] = pixel(c % 2 == 0 ? 0x00 : 0x80, color.r, color.g, color.b);
+            }
+            else if ((row == 0 || row == 3) && c % 3 != 2) {
+                const int *delta = c % 3 == 0 ? at[(c / 3) % 6] : past[(c / 3) % 6];
+                line[c] = pixel(0xFF, color.r + delta[0], color.g + delta[1], color.b + delta[2]);
+            }
+        }
+    }
+}
+
+
+/**
+ * @brief Counts matching pixels of a hand-built frame with every kernel the CPU supports:
+ * pixels exactly at and one past the tolerance, every width from 1 to past the frame from
+ * three starting columns (the tails of the vector kernels), regions clipped at each edge
+ * and outside the frame, a frame that does not start at the screen's origin, and the
+ * tolerance clamped and widened.
+ * @return Number of failed checks
+ */
+int test_match(void) {
+    Frame frame = {0};
+    if (!frame_reserve(&frame, TEST_MATCH_WIDTH, TEST_MATCH_HEIGHT)) {
+        return 1;
+    }
+    frame.x = TEST_MATCH_X;
+    frame.y = TEST_MATCH_Y;
+    RGBColor color = {100, 150, 200};
+    paint_pattern(&frame, color);
+
+    MatchKernel active = match_active_kernel();
+    int checks = 0, failures = 0, kernels = 0;
+    char names[64] = "";
+    for (int kernel = 0; kernel < MATCH_KERNEL_COUNT; kernel++) {
+        if (!match_use_kernel((MatchKernel)kernel)) {
+            continue;
+        }
+        kernels++;
+        snprintf(names + strlen(names), sizeof(names) - strlen(names), " %s", match_kernel_name((MatchKernel)kernel));
+        int tol = TEST_MATCH_TOLERANCE, x = TEST_MATCH_X, y = TEST_MATCH_Y;
+
+        // The whole frame: a third of both pattern rows and the colored row whatever its alpha
+        checks++;
+        failures += count_matching_pixels(&frame, x, y, TEST_MATCH_WIDTH, TEST_MATCH_HEIGHT, color, tol) !=
+                    2 * pattern_matches(0, TEST_MATCH_WIDTH) + TEST_MATCH_WIDTH;
+
+        // Every width, from aligned and unaligned columns
+        static const int starts[] = {0, 1, 3};
+        for (int s = 0; s < 3; s++) {
+            for (int width = 1; width <= TEST_MATCH_WIDTH + 4; width++) {
+                checks++;
+                failures += count_matching_pixels(&frame, x + starts[s], y, width, 1, color, tol) !=
+                            pattern_matches(starts[s], width);
+            }
+        }
+
+        // Clipped at the top-left corner: columns 0-14 of rows 0 and 1
+        checks++;
+        failures += count_matching_pixels(&frame, x - 5, y - 2, 20, 4, color, tol) != pattern_matches(0, 15) + 15;
+        // Clipped at the bottom-right corner: columns 30-36 of rows 1 to 5
+        checks++;
+        failures += count_matching_pixels(&frame, x + 30, y + 1, 50, 50, color, tol) != 7 + pattern_matches(30, 7);
+        // Left of, above and past the frame
+        checks++;
+        failures += count_matching_pixels(&frame, 0, 0, x, y + TEST_MATCH_HEIGHT, color, tol) != 0 ||
+                    count_matching_pixels(&frame, x, 0, TEST_MATCH_WIDTH, y, color, tol) != 0 ||
+                    count_matching_pixels(&frame, x + TEST_MATCH_WIDTH, y, 10, TEST_MATCH_HEIGHT, color, tol) != 0 ||
+                    count_matching_pixels(&frame, x, y, 0, TEST_MATCH_HEIGHT, color, tol) != 0;
+
+        // One more of tolerance takes the pixels one past it, none takes only the color itself
+        checks++;
+        failures += count_matching_pixels(&frame, x, y, TEST_MATCH_WIDTH, 1, color, tol + 1) !=
+                    TEST_MATCH_WIDTH - TEST_MATCH_WIDTH / 3;
+        checks++;
+        failures += count_matching_pixels(&frame, x, y, TEST_MATCH_WIDTH, TEST_MATCH_HEIGHT, color, 0) != TEST_MATCH_WIDTH ||
+                    count_matching_pixels(&frame, x, y, TEST_MATCH_WIDTH, TEST_MATCH_HEIGHT, color, -5) != TEST_MATCH_WIDTH;
+    }
+    match_use_kernel(active);
+    frame_free(&frame);
+
+    checks++;
+    failures += kernels == 0 || !match_kernel_supported(MATCH_SCALAR);
+    printf("\nRegion match kernels%s: %d/%d checks passed", names, checks - failures, checks);
+    return failures;
+}
@@ -0,0 +1,126 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "recording.h"
+#include "tests.h"
+
+
+/**
+ * @brief Farms the first mode on any backend until its clock reaches until_ms
+ * @return Input sequences dispatched, -1 if the scheduler could not be set up
+ */
+static int farm_until(Backend *backend, uint64_t until_ms) {
+    static Scheduler scheduler;
+    if (!scheduler_init(&scheduler, backend, &test_config, &test_config.modes[0], &test_anchor, TEST_SETTLE_MS, NULL)) {
+        return -1;
+    }
+    scheduler_run(&scheduler, until_ms);
+    int dispatched = scheduler.dispatched;
+    scheduler_free(&scheduler);
+    return dispatched;
+}
+
+
+/**
+ * @brief Records a simulated session, then replays it twice: once through the same farm
+ * loop, which must send exactly the recorded input, and once seeking to frames at random,
+ * which must decode the same pixels as reading them in order
+ * @return Number of failed checks
+ */
+int test_recording(double hours) {
+    const char *path = "recording-check.mrec";
+    SimulatorConfig sim_config;
+    simulator_default_config(&sim_config);
+    Backend *sim = simulator_create(&sim_config);
+    Backend *backend = sim != NULL ? recorder_create(sim, path) : NULL;
+    if (backend == NULL) {
+        backend_destroy(sim);
+        return 1;
+    }
+    uint64_t started = system_now_us();
+    int dispatched = farm_until(backend, backend->now_ms(backend) + (uint64_t)(hours * 3600000.0));
+    uint64_t record_us = system_now_us() - started;
+    RecordingStats recorded = recorder_stats(backend);
+    backend_destroy(backend);
+    backend_destroy(sim);
+    if (dispatched < 0) {
+        remove(path);
+        return 1;
+    }
+
+    int checks = 0, failures = 0;
+    backend = replay_create(path);
+    if (backend == NULL) {
+        remove(path);
+        return 1;
+    }
+    RecordingStats opened = replay_stats(backend);
+    checks++;
+    failures += opened.frames != recorded.frames || opened.keyframes != recorded.keyframes ||
+                opened.inputs != recorded.inputs || opened.raw_bytes != recorded.raw_bytes;
+
+    started = system_now_us();
+    int replayed_dispatched = farm_until(backend, opened.last_ms + 1);
+    uint64_t replay_us = system_now_us() - started;
+    RecordingStats replayed = replay_stats(backend);
+    checks++;
+    failures += replayed.replayed != recorded.frames || replayed.matched != recorded.inputs ||
+                replayed.diverged != 0 || replayed_dispatched != dispatched;
+    backend_destroy(backend);
+
+    // Fingerprints of every frame in order, then of frames reached by seeking
+    Backend *replay = replay_create(path);
+    uint64_t *fingerprints = replay != NULL ? malloc((size_t)recorded.frames * sizeof(uint64_t)) : NULL;
+    Frame frame = {0};
+    if (fingerprints != NULL) {
+        for (uint32_t i = 0; i < recorded.frames; i++) {
+            fingerprints[i] = replay->capture(replay, 0, 0, 0, 0, &frame) ? frame_fingerprint(&frame) : 0;
+        }
+        uint32_t seed = 77;
+        for (int i = 0; i < 200 && recorded.frames > 0; i++) {
+            seed = seed * 1664525u + 1013904223u;
+            uint32_t n = (seed >> 8) % recorded.frames;
+            checks++;
+            failures += !replay_seek(replay, n) || !replay->capture(replay, 0, 0, 0, 0, &frame) ||
+                        frame_fingerprint(&frame) != fingerprints[n];
+        }
+    }
+    else {
+        failures++;
+    }
+    frame_free(&frame);
+    free(fingerprints);
+    backend_destroy(replay);
+
+    // Killed while recording: the first half of the file still plays, up to its last whole record
+    const char *cut_path = "recording-check-cut.mrec";
+    FILE *whole = fopen(path, "rb"), *cut = fopen(cut_path, "wb");
+    for (uint64_t i = 0; whole != NULL && cut != NULL && i < opened.bytes / 2; i++) {
+        fputc(fgetc(whole), cut);
+    }
+    if (whole != NULL) {
+        fclose(whole);
+    }
+    if (cut != NULL) {
+        fclose(cut);
+    }
+    replay = replay_create(cut_path);
+    RecordingStats partial = {0};
+    if (replay != NULL) {
+        partial = replay_stats(replay);
+    }
+    checks++;
+    failures += replay == NULL || partial.frames == 0 || partial.frames >= recorded.frames ||
+                !replay_seek(replay, partial.frames - 1) || !replay->capture(replay, 0, 0, 0, 0, &frame);
+    frame_free(&frame);
+    backend_destroy(replay);
+    remove(cut_path);
+    remove(path);
+
+    printf("\nRecording, %s %.1f h: %u frames (%u keyframes), %u inputs, %.1f MB of %.0f MB raw (1:%.0f)"
+           "  record: %.1f s  replay: %.2f s (%.0f frames/s)  %d/%d checks passed",
+           test_config.modes[0].title, hours, recorded.frames, recorded.keyframes, recorded.inputs,
+           opened.bytes / 1e6, opened.raw_bytes / 1e6, opened.bytes > 0 ? (double)opened.raw_bytes / opened.bytes : 0.0,
+           record_us / 1e6, replay_us / 1e6, replay_us > 0 ? recorded.frames * 1e6 / replay_us : 0.0,
+           checks - failures, checks);
+    return failures;
+}
@@ -0,0 +1,81 @@
+#include <stdio.h>
+#include <string.h>
+#include "tests.h"
+
+
+/**
+ * @brief Gold farm over three objects with mixed cooldowns on the simulated client: once
+ * clicking only world_object, once rotating over all three with cooldowns learned from
+ * scratch. Checks that the rotation wins more fights, counts every fight against the right
+ * object and learns every cooldown.
+ * @return Number of failed checks
+ */
+int test_rotation(double hours) {
+    static Scheduler scheduler;
+    static GameConfig rotating;
+    static const char *names[] = {"spawn_west", "spawn_east"};
+    static const Point positions[] = {{300, 420}, {1050, 400}};
+    static const unsigned cooldowns[] = {60000, 20000, 45000};
+
+    rotating = test_config;
+    GameMode *mode = &rotating.modes[0];
+    Spawn first = {COORD_WORLD_OBJECT, 0};
+    mode->spawns[mode->spawn_count++] = first;
+    for (int i = 0; i < 2 && rotating.point_count < COORD_CUSTOM_MAX; i++) {
+        snprintf(rotating.point_names[rotating.point_count], CONFIG_NAME_LENGTH, "%s", names[i]);
+        rotating.points[rotating.point_count] = positions[i];
+        Spawn spawn = {(CoordId)(COORD_COUNT + rotating.point_count++), 0};
+        mode->spawns[mode->spawn_count++] = spawn;
+    }
+    int world = config_find_state(&rotating, "world");
+    if (world == STATE_UNKNOWN || mode->spawn_count != 3) {
+        return 1;
+    }
+    mode->actions[world].kind = ACTION_ENGAGE;
+
+    SimulatorConfig sim_config;
+    simulator_default_config(&sim_config);
+    Point object = {COORD_DEFS[COORD_WORLD_OBJECT].base_x, COORD_DEFS[COORD_WORLD_OBJECT].base_y};
+    sim_config.spawn_count = 3;
+    for (int i = 0; i < 3; i++) {
+        sim_config.spawns[i].position = i == 0 ? object : positions[i - 1];
+        sim_config.spawns[i].cooldown_ms = cooldowns[i];
+    }
+
+    int checks = 0, failures = 0;
+    double fights_per_hour[2] = {0.0, 0.0};
+    printf("\nSpawn rotation, 3 objects with cooldowns %u/%u/%u s, %.1f h:", cooldowns[0] / 1000, cooldowns[1] / 1000,
+           cooldowns[2] / 1000, hours);
+    for (int pass = 0; pass < 2; pass++) {
+        const GameConfig *game = pass == 0 ? &test_config : &rotating;
+        Backend *backend = test_start(&scheduler, &sim_config, game, &game->modes[0]);
+        if (backend == NULL) {
+            return failures + 1;
+        }
+        test_run(&scheduler, hours);
+        SimulatorStats stats = simulator_stats(backend);
+        double elapsed_hours = stats.elapsed_ms / 3600000.0;
+        fights_per_hour[pass] = stats.fights / elapsed_hours;
+        printf("\n  %-15s fights/hour: %6.1f  idle per cycle: %6.0f ms  missed clicks: %d", pass == 0 ? "world_object only" : "rotation",
+               fights_per_hour[pass], stats.fights > 0 ? (double)stats.idle_ms / stats.fights : 0.0, stats.missed_clicks);
+
+        const Rotation *rotation = &scheduler.instances[0].bot.rotation;
+        for (int i = 0; i < rotation->count && pass == 1; i++) {
+            const RotationTarget *target = &rotation->targets[i];
+            uint32_t learned = rotation_cooldown(target);
+            printf("\n    %-16s fights/hour: %6.1f  cooldown: %5.1f s learned %5.1f s  clicks on cooldown: %d",
+                   config_coord_name(game, target->target), target->fights / elapsed_hours, cooldowns[i] / 1000.0,
+                   learned / 1000.0, target->busy_clicks);
+            // The simulator counts a fight once it is won, the rotation once it started
+            checks++;
+            failures += target->fights < stats.spawn_fights[i] || target->fights > stats.spawn_fights[i] + 1 ||
+                        learned + ROTATION_PRECISION_MS + WAIT_MAX_POLL_MS < cooldowns[i] ||
+                        learned > cooldowns[i] + ROTATION_PRECISION_MS + WAIT_MAX_POLL_MS;
+        }
+        test_stop(&scheduler, backend);
+    }
+    checks++;
+    failures += fights_per_hour[1] <= fights_per_hour[0];
+    printf("\n  %d/%d checks passed", checks - failures, checks);
+    return failures;
+}
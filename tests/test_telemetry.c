@@ -0,0 +1,117 @@
+#include <stdio.h>
+#include <string.h>
+#include "telemetry.h"
+#include "tests.h"
+
+// Written next to the runner and removed again
+#define TEST_TELEMETRY_PREFIX "test_telemetry"
+
+
+/**
+ * @brief Screens one game window goes through, as the bot reports them
+ */
+static void phases(Telemetry *telemetry, int instance, const int *states, int count, uint64_t *time_ms) {
+    int previous = STATE_UNKNOWN;
+    for (int i = 0; i < count; i++) {
+        telemetry_record(telemetry, TELEMETRY_PHASE, instance, states[i], previous, 1000, *time_ms);
+        previous = states[i];
+        *time_ms += 1000;
+    }
+}
+
+
+/**
+ * @brief Counts the fights of a scripted event stream
+ */
+static uint64_t count_fights(const GameConfig *config, bool with_stall, uint64_t *time_ms) {
+    Telemetry *telemetry = telemetry_start(config, NULL);
+    if (telemetry == NULL) {
+        return 0;
+    }
+    int world = config_find_state(config, "world"), battle = config_find_state(config, "battle");
+    int victory = config_find_state(config, "victory"), ready = config_find_state(config, "ready_to_train");
+    int first = victory != STATE_UNKNOWN ? victory : world;
+    // Won, won through frames no signature matched, and a second window that left the battle for the world view
+    const int won[] = {world, battle, first, world};
+    const int won_late[] = {world, battle, STATE_UNKNOWN, ready};
+    const int left[] = {world, battle, world};
+    phases(telemetry, 0, won, 4, time_ms);
+    phases(telemetry, 0, won_late, 4, time_ms);
+    phases(telemetry, 1, left, 3, time_ms);
+    if (with_stall) {
+        // Stuck in battle, then restarted to the world view: no fight won
+        const int stuck[] = {world, battle};
+        const int restarted[] = {STATE_UNKNOWN, world};
+        phases(telemetry, 0, stuck, 2, time_ms);
+        telemetry_record(telemetry, TELEMETRY_STALL, 0, battle, 0, 120000, *time_ms);
+        phases(telemetry, 0, restarted, 2, time_ms);
+    }
+    telemetry_stop(telemetry);
+    uint64_t fights = telemetry->fights;
+    telemetry_free(telemetry);
+    return fights;
+}
+
+
+/**
+ * @brief Feeds scripted screen changes of two game windows to the telemetry and checks the
+ * fights it counts: only battles won, not battles left through a stall and a restart. A data
+ * file without a victory state counts a battle left for any known screen. Then checks that
+ * the summary is in place after the last rewrite, without its temporary file.
+ * @return Number of failed checks
+ */
+int test_telemetry(void) {
+    static GameConfig no_victory;
+    int checks = 0, failures = 0;
+    uint64_t time_ms = 1000;
+
+    uint64_t fights = count_fights(&test_config, true, &time_ms);
+    checks++;
+    failures += fights != 2;
+
+    // The victory screen reads as the world view
+    no_victory = test_config;
+    int victory = config_find_state(&no_victory, "victory");
+    if (victory != STATE_UNKNOWN) {
+        snprintf(no_victory.states[victory].name, CONFIG_NAME_LENGTH, "banner");
+    }
+    uint64_t any_fights = count_fights(&no_victory, true, &time_ms);
+    checks++;
+    failures += any_fights != 3;
+
+    // Two sessions with one and two fights: the second summary replaces the first
+    const int won[] = {config_find_state(&test_config, "world"), config_find_state(&test_config, "battle"),
+                       config_find_state(&test_config, "victory")};
+    for (int session = 1; session <= 2; session++) {
+        Telemetry *telemetry = telemetry_start(&test_config, TEST_TELEMETRY_PREFIX);
+        if (telemetry == NULL) {
+            break;
+        }
+        for (int fight = 0; fight < session; fight++) {
+            phases(telemetry, 0, won, 3, &time_ms);
+        }
+        telemetry_free(telemetry);
+    }
+    FILE *summary = fopen(TEST_TELEMETRY_PREFIX ".json", "r");
+    FILE *temporary = fopen(TEST_TELEMETRY_PREFIX ".json.tmp", "r");
+    char text[4096] = {0};
+    if (summary != NULL) {
+        size_t length = fread(text, 1, sizeof(text) - 1, summary);
+        text[length] = '\0';
+        fclose(summary);
+    }
+    bool replaced = summary != NULL && temporary == NULL && strstr(text, "\"fights\": 2,") != NULL;
+    if (temporary != NULL) {
+        fclose(temporary);
+    }
+    remove(TEST_TELEMETRY_PREFIX ".json");
+    remove(TEST_TELEMETRY_PREFIX ".json.tmp");
+    remove(TEST_TELEMETRY_PREFIX ".csv");
+    checks++;
+    failures += !replaced;
+
+    printf("\nTelemetry: fights counted %llu of 2 won (victory screen), %llu of 3 (no victory screen), summary %s"
+           "  %d/%d checks passed", (unsigned long long)fights, (unsigned long long)any_fights,
+           replaced ? "replaced" : "missing", checks - failures, checks);
+    return failures;
+}
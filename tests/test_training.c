@@ -0,0 +1,70 @@
+#include <stdio.h>
+#include <string.h>
+#include "tests.h"
+
+
+/**
+ * @brief Trains a team of four on the simulated client, its members apart in experience.
+ * The default mode trains the first slot once per visit of the training window. The batched
+ * mode opens the window once one, two or three members are ready and trains all of them.
+ * Training costs fights, measured against the gold farm: the configured batch must give up
+ * fewer fights per training than the default mode and than one visit per member, and it must
+ * train more. The window must open less often the larger the batch, and nothing may stall.
+ * @return Number of failed checks
+ */
+int test_training(double hours) {
+    enum { GOLD, SINGLE };
+    static Scheduler scheduler;
+    static GameConfig batched;
+    const GameMode *gold = config_find_mode(&test_config, "gold");
+    const GameMode *single = config_find_mode(&test_config, "train");
+    const GameMode *batch = config_find_mode(&test_config, "train_batch");
+    int window = config_find_state(&test_config, "train_window");
+    if (gold == NULL || single == NULL || batch == NULL || window == STATE_UNKNOWN || test_config.team_size < 4 ||
+        batch->actions[window].kind != ACTION_TRAIN || batch->batch < 1 || batch->batch > 3) {
+        printf("\nTraining: the data file has no mode \"gold\", \"train\" or batched \"train_batch\" with a team of four");
+        return 1;
+    }
+    batched = test_config;
+    GameMode *mode = &batched.modes[batch - test_config.modes];
+    int configured = SINGLE + batch->batch;
+
+    // Gold farm, the default mode, then batches of one to three members
+    int checks = 0, failures = 0;
+    SimulatorStats results[5];
+    double fights_per_hour[5], trainings_per_hour[5], cost[5];
+    printf("\nTraining, team of %d, %.1f h, fights given up per training against the gold farm:", SIM_MAX_TEAM, hours);
+    for (int pass = 0; pass < 5; pass++) {
+        mode->batch = pass - SINGLE;
+        const GameMode *farmed = pass == GOLD ? gold : pass == SINGLE ? single : mode;
+        SimulatorConfig sim_config;
+        simulator_default_config(&sim_config);
+        sim_config.team_size = SIM_MAX_TEAM;
+        Backend *backend = test_start(&scheduler, &sim_config, pass > SINGLE ? &batched : &test_config, farmed);
+        if (backend == NULL) {
+            return failures + 1;
+        }
+        test_run(&scheduler, hours);
+        SimulatorStats stats = results[pass] = simulator_stats(backend);
+        fights_per_hour[pass] = test_fights_per_hour(&stats);
+        trainings_per_hour[pass] = stats.trainings / (stats.elapsed_ms / 3600000.0);
+        double lost = fights_per_hour[GOLD] - fights_per_hour[pass];
+        cost[pass] = trainings_per_hour[pass] > 0 ? (lost > 0 ? lost : 0.0) / trainings_per_hour[pass] : 0.0;
+        char title[32];
+        snprintf(title, sizeof(title), "batch %d%s", pass - SINGLE, pass == configured ? " (cfg)" : "");
+        printf("\n  %-15s fights/hour: %6.1f  trainings/hour: %6.1f  per training: %5.3f  window opens: %3d"
+               "  trainings per visit: %4.2f  stalls: %d",
+               pass <= SINGLE ? farmed->name : title, fights_per_hour[pass], trainings_per_hour[pass], cost[pass],
+               stats.window_opens, stats.window_opens > 0 ? (double)stats.trainings / stats.window_opens : 0.0,
+               scheduler.instances[0].watchdog.incidents);
+        checks++;
+        failures += scheduler.instances[0].watchdog.incidents != 0;
+        test_stop(&scheduler, backend);
+    }
+    checks += 3;
+    failures += results[configured].trainings <= results[SINGLE].trainings || cost[configured] >= cost[SINGLE];
+    failures += configured != SINGLE + 1 && cost[configured] >= cost[SINGLE + 1];
+    failures += results[3].window_opens >= results[2].window_opens || results[4].window_opens >= results[3].window_opens;
+    printf("\n  %d/%d checks passed", checks - failures, checks);
+    return failures;
+}
@@ -0,0 +1,264 @@
+#include <stdio.h>
+#include "bot.h"
+#include "frame.h"
+#include "tests.h"
+#include "wait.h"
+
+#define TEST_WAIT_MAX_CHANGES 16
+// Timeouts of the click that waits for a new state and of the routine steps that wait for a settle
+#define TEST_WAIT_STATE_MS 3000
+#define TEST_WAIT_STEP_MS 1000
+
+/**
+ * @brief A screen that plays a script: from each change on (ms after the script started)
+ * it shows a gray background of its shade with the signature of its state on top
+ */
+typedef struct {
+    const GameConfig *config;
+    const CoordTable *coords;
+    uint64_t at_ms[TEST_WAIT_MAX_CHANGES];
+    int state[TEST_WAIT_MAX_CHANGES];
+    int shade[TEST_WAIT_MAX_CHANGES];
+    int count;
+    uint64_t started;
+} ScriptedScreen;
+
+
+/**
+ * @brief Paints the last change the script reached: the background, then every pixel and
+ * region the state's signature expects in its color
+ */
+static void scripted_paint(void *ctx, uint64_t now, Frame *frame) {
+    const ScriptedScreen *screen = ctx;
+    int state = STATE_UNKNOWN, shade = 0;
+    for (int i = 0; i < screen->count && screen->started + screen->at_ms[i] <= now; i++) {
+        state = screen->state[i];
+        shade = screen->shade[i];
+    }
+    RGBColor background = {shade, shade, shade};
+    frame_fill(frame, frame->x, frame->y, frame->width, frame->height, background);
+    if (state == STATE_UNKNOWN) {
+        return;
+    }
+    const Signature *signature = &screen->config->states[state];
+    for (int i = 0; i < signature->probe_count; i++) {
+        const SignatureProbe *probe = &signature->probes[i];
+        Point center = coord_screen(screen->coords, probe->coord);
+        if (probe->absent) {
+            continue;
+        }
+        if (probe->width <= 0) {
+            frame_set(frame, center.x, center.y, probe->color);
+        }
+        else {
+            frame_fill(frame, center.x - probe->width / 2, center.y - probe->height / 2, probe->width, probe->height, probe->color);
+        }
+    }
+}
+
+
+/**
+ * @brief Starts a new script at the current time of the fake screen, nothing shown until its first change
+ */
+static void script_begin(ScriptedScreen *screen, const FakeScreen *fake) {
+    screen->count = 0;
+    screen->started = fake->now;
+}
+
+
+static void script_change(ScriptedScreen *screen, uint64_t at_ms, int state, int shade) {
+    if (screen->count < TEST_WAIT_MAX_CHANGES) {
+        screen->at_ms[screen->count] = at_ms;
+        screen->state[screen->count] = state;
+        screen->shade[screen->count++] = shade;
+    }
+}
+
+
+/**
+ * @brief Serves the bot like the scheduler does, one capture per decision, until it clicks
+ * @return Time of the click, 0 if it did not click within limit_ms
+ */
+static uint64_t run_until_click(Backend *backend, Bot *bot, Frame *frame, unsigned limit_ms) {
+    FakeScreen *fake = backend->ctx;
+    ScreenMetrics screen = backend->metrics(backend);
+    uint64_t until = fake->now + limit_ms;
+    while (fake->now <= until) {
+        if (!backend->capture(backend, 0, 0, screen.width, screen.height, frame)) {
+            return 0;
+        }
+        BotDecision decision = bot_step(bot, frame, frame->time_ms);
+        if (decision.click) {
+            return frame->time_ms;
+        }
+        backend->sleep_ms(backend, decision.delay_ms);
+    }
+    return 0;
+}
+
+
+/**
+ * @brief Starts the bot afresh on a screen that shows the state, and runs it to its first click
+ * @return Time of the click, 0 if there was none
+ */
+static uint64_t first_click(Backend *backend, Bot *bot, Frame *frame, ScriptedScreen *screen, int state) {
+    bot_init(bot, screen->config, bot->mode, screen->coords, TEST_SETTLE_MS);
+    script_begin(screen, backend->ctx);
+    script_change(screen, 0, state, 60);
+    return run_until_click(backend, bot, frame, TEST_WAIT_STEP_MS);
+}
+
+
+/**
+ * @brief Checks the poll schedule of the waits, then runs the bot's waits against a scripted
+ * screen: after a click on the world view the new state must be seen within the interval of
+ * the poll it fell in (at most half the time waited so far plus the first interval, and never
+ * more than the longest one), and a screen that stays the same repeats the click right at the
+ * timeout with few polls. A routine step must see an animation as settled only once it stopped
+ * for the settle time, not later than two capped intervals after (one to see the last frame,
+ * one to see it still), and time out on a screen that never moves or never stops.
+ * @return Number of failed checks
+ */
+int test_wait(void) {
+    static GameConfig config;
+    static GameMode mode;
+    static ScriptedScreen screen;
+    static Bot bot;
+    int checks = 0, failures = 0;
+
+    // The world view clicks and waits for the next state, the battle runs a routine of two steps
+    config = test_config;
+    int world = config_find_state(&config, "world"), battle = config_find_state(&config, "battle");
+    if (world == STATE_UNKNOWN || battle == STATE_UNKNOWN || config.routine_count >= MAX_ROUTINES) {
+        printf("\nWaits: the data file has no world view or battle state");
+        return 1;
+    }
+    Routine *routine = &config.routines[config.routine_count];
+    RoutineStep first = {COORD_ABILITY, TEST_WAIT_STEP_MS}, second = {COORD_CLOSE_FIGHT, TEST_WAIT_STEP_MS};
+    routine->steps[0] = first;
+    routine->steps[1] = second;
+    routine->step_count = 2;
+    Action click = {ACTION_CLICK, COORD_WORLD_OBJECT, TEST_WAIT_STATE_MS, -1};
+    Action run = {ACTION_RUN, COORD_WORLD_OBJECT, 0, config.routine_count++};
+    mode.actions[world] = click;
+    mode.actions[battle] = run;
+    bot.mode = &mode;
+
+    ScreenMetrics metrics = {BASE_SCREEN_WIDTH, BASE_SCREEN_HEIGHT};
+    GameArea whole = {0, 0, BASE_SCREEN_WIDTH, BASE_SCREEN_HEIGHT, 0};
+    CoordTable coords = {0};
+    coord_table_set_custom(&coords, config.points, config.point_count);
+    coord_table_build(&coords, metrics, whole);
+    screen.config = &config;
+    screen.coords = &coords;
+    Backend *backend = test_fake_create(metrics, scripted_paint, &screen);
+    if (backend == NULL) {
+        return 1;
+    }
+    FakeScreen *fake = backend->ctx;
+    Frame frame = {0};
+
+    // The backoff: from the shortest interval up to the longest, never shrinking
+    Waiter waiter;
+    uint64_t now = 0;
+    waiter_start(&waiter, now, 10000);
+    unsigned delay = waiter_next_delay(&waiter, now), previous = delay;
+    bool growing = delay == WAIT_MIN_POLL_MS;
+    for (int i = 0; i < 20; i++) {
+        now += delay;
+        delay = waiter_next_delay(&waiter, now);
+        growing = growing && delay >= previous && delay <= WAIT_MAX_POLL_MS;
+        previous = delay;
+    }
+    checks++;
+    failures += !growing || delay != WAIT_MAX_POLL_MS;
+
+    // Shorter intervals on demand, never longer ones
+    waiter_cap(&waiter, 26);
+    waiter_cap(&waiter, 500);
+    checks++;
+    failures += waiter_next_delay(&waiter, now) != 26;
+
+    // The last interval ends at the deadline, nothing is left after it, and every interval was a poll
+    waiter_start(&waiter, 0, 100);
+    now = 0;
+    int intervals = 0;
+    while ((delay = waiter_next_delay(&waiter, now)) > 0) {
+        now += delay;
+        intervals++;
+    }
+    checks++;
+    failures += now != 100 || waiter_next_delay(&waiter, 250) != 0 || waiter.polls != intervals;
+
+    // The battle comes up a while after the click on the world view, its routine is clicked once it is seen
+    const uint64_t change_ms[] = {5, 40, 300, 2500};
+    unsigned worst_ms = 0;
+    bool seen = true;
+    for (int i = 0; i < 4; i++) {
+        uint64_t clicked = first_click(backend, &bot, &frame, &screen, world);
+        script_begin(&screen, fake);
+        script_change(&screen, 0, world, 60);
+        script_change(&screen, change_ms[i], battle, 60);
+        uint64_t noticed = run_until_click(backend, &bot, &frame, TEST_WAIT_STATE_MS);
+        unsigned latency = (unsigned)(noticed - clicked - change_ms[i]);
+        unsigned bound = (unsigned)change_ms[i] / 2 + WAIT_MIN_POLL_MS;
+        if (bound > WAIT_MAX_POLL_MS) {
+            bound = WAIT_MAX_POLL_MS;
+        }
+        seen = seen && clicked != 0 && noticed >= clicked + change_ms[i] && latency <= bound &&
+               bot.progress == 1 && bot.timeouts == 0;
+        if (latency > worst_ms) {
+            worst_ms = latency;
+        }
+    }
+    checks++;
+    failures += !seen;
+
+    // The world view stays: the click is repeated at the timeout, polled far less than every 10 ms
+    uint64_t clicked = first_click(backend, &bot, &frame, &screen, world);
+    int captures = fake->captures;
+    uint64_t repeated = run_until_click(backend, &bot, &frame, 2 * TEST_WAIT_STATE_MS);
+    int polls = fake->captures - captures;
+    unsigned still_ms = (unsigned)(repeated - clicked);
+    checks++;
+    failures += clicked == 0 || still_ms != TEST_WAIT_STATE_MS || bot.timeouts != 1 || bot.progress != 0 ||
+                polls * 5 > TEST_WAIT_STATE_MS / WAIT_MIN_POLL_MS;
+
+    // A battle animation from 100 to 380 ms after the first step, every frame different:
+    // the second step is clicked once it stopped for the settle time
+    clicked = first_click(backend, &bot, &frame, &screen, battle);
+    script_begin(&screen, fake);
+    script_change(&screen, 0, battle, 60);
+    for (int i = 0; i <= 7; i++) {
+        script_change(&screen, 100 + 40 * (uint64_t)i, battle, 70 + 15 * i);
+    }
+    unsigned stopped_ms = 100 + 40 * 7;
+    uint64_t settled = run_until_click(backend, &bot, &frame, 2 * TEST_WAIT_STEP_MS);
+    unsigned settled_ms = (unsigned)(settled - clicked);
+    checks++;
+    failures += clicked == 0 || settled_ms < stopped_ms + TEST_SETTLE_MS ||
+                settled_ms > stopped_ms + TEST_SETTLE_MS + 2 * (TEST_SETTLE_MS / 2 + 1) || bot.routine_timeouts != 0;
+
+    // Nothing moved after the first step, so nothing settled: the second step comes at its timeout
+    clicked = first_click(backend, &bot, &frame, &screen, battle);
+    uint64_t unchanged = run_until_click(backend, &bot, &frame, 2 * TEST_WAIT_STEP_MS);
+    checks++;
+    failures += clicked == 0 || unchanged != clicked + TEST_WAIT_STEP_MS || bot.routine_timeouts != 1;
+
+    // Still moving at the timeout
+    clicked = first_click(backend, &bot, &frame, &screen, battle);
+    script_begin(&screen, fake);
+    for (int i = 0; i < TEST_WAIT_MAX_CHANGES; i++) {
+        script_change(&screen, 50 + 100 * (uint64_t)i, battle, 70 + 10 * (i % 2));
+    }
+    uint64_t moving = run_until_click(backend, &bot, &frame, 2 * TEST_WAIT_STEP_MS);
+    checks++;
+    failures += clicked == 0 || moving != clicked + TEST_WAIT_STEP_MS || bot.routine_timeouts != 1;
+
+    printf("\nWaits of the bot: new state seen within %u ms at worst, unchanged world view %d polls in %u ms,"
+           " settled %u ms after the animation stopped  %d/%d checks passed", worst_ms, polls, still_ms,
+           settled_ms - stopped_ms, checks - failures, checks);
+    frame_free(&frame);
+    backend_destroy(backend);
+    return failures;
+}
@@ -0,0 +1,159 @@
+#include <stdio.h>
+#include <string.h>
+#include "tests.h"
+
+
+/**
+ * @brief Restart hook of the simulated client, which knows it by its window
+ */
+static bool restart_simulated(void *ctx, int instance, const GameArea *window) {
+    (void)instance;
+    int client = simulator_client((Backend *)ctx, window);
+    simulator_restart((Backend *)ctx, client);
+    return client >= 0;
+}
+
+
+/**
+ * @brief Throws a menu, a reward popup over the world and a lost connection at the simulated
+ * client in turn, and checks that the watchdog gets it going again with the step meant for
+ * each: Esc, the popup's close button and a restart. Compares the fights with a run without
+ * the watchdog and checks it learned a tighter limit than the data file's for the world view.
+ * Then opens menus in the first of two clients, where the other one has the focus, for Esc
+ * to close, and disconnects it: every client must keep its own window although the window
+ * list comes front to back and the restart opens a new one. Last, checks that farming
+ * without faults raises no stall in any mode.
+ * @return Number of failed checks
+ */
+int test_watchdog(double hours) {
+    static Scheduler scheduler;
+    static GameConfig watched;
+    static const char *names[] = {"menu", "popup", "disconnect"};
+    static const RecoveryKind fixes[] = {RECOVERY_ESCAPE, RECOVERY_CLOSE, RECOVERY_RESTART};
+    const uint64_t fault_every = 300000;
+
+    // The popup's close button goes first, so each fault has one step that fixes it
+    watched = test_config;
+    WatchdogConfig *settings = &watched.watchdog;
+    if (watched.point_count >= COORD_CUSTOM_MAX || settings->close_count >= MAX_CLOSE_BUTTONS || settings->stall_ms == 0) {
+        printf("\nWatchdog: the data file turns it off or leaves no room for the popup's close button");
+        return 1;
+    }
+    snprintf(watched.point_names[watched.point_count], CONFIG_NAME_LENGTH, "popup_close");
+    Point popup_close = {SIM_POPUP_CLOSE_X, SIM_POPUP_CLOSE_Y};
+    watched.points[watched.point_count] = popup_close;
+    memmove(&settings->closes[1], &settings->closes[0], settings->close_count * sizeof(CoordId));
+    settings->closes[0] = (CoordId)(COORD_COUNT + watched.point_count++);
+    settings->close_count++;
+
+    int checks = 0, failures = 0;
+    double fights_per_hour[2] = {0.0, 0.0};
+    // One fault of each kind at least, the last one with time to recover
+    int faults = (int)(hours * 3600000.0 / fault_every) - 1;
+    if (faults < 3) {
+        faults = 3;
+    }
+    printf("\nWatchdog, %s, a fault every %llu s (%d), stall after %u s (%u s on no known screen):", test_config.modes[0].title,
+           (unsigned long long)fault_every / 1000, faults, settings->stall_ms / 1000, settings->unknown_ms / 1000);
+    for (int pass = 0; pass < 2; pass++) {
+        unsigned stall_ms = settings->stall_ms;
+        if (pass == 0) {
+            settings->stall_ms = 0;
+        }
+        SimulatorConfig sim_config;
+        simulator_default_config(&sim_config);
+        Backend *backend = test_start(&scheduler, &sim_config, &watched, &watched.modes[0]);
+        settings->stall_ms = stall_ms;
+        if (backend == NULL) {
+            return failures + 1;
+        }
+        if (pass == 1) {
+            scheduler_set_restart(&scheduler, restart_simulated, backend);
+        }
+        uint64_t start = backend->now_ms(backend);
+        for (int i = 0; i < faults; i++) {
+            scheduler_run(&scheduler, start + (i + 1) * fault_every);
+            simulator_inject(backend, 0, (SimFault)(i % 3));
+        }
+        scheduler_run(&scheduler, start + (faults + 1) * fault_every);
+        SimulatorStats stats = simulator_stats(backend);
+        const Watchdog *watchdog = &scheduler.instances[0].watchdog;
+        fights_per_hour[pass] = test_fights_per_hour(&stats);
+        printf("\n  %-15s fights/hour: %6.1f  stalls: %d  recovered: %d  downtime per stall: %5.1f s  per 24 h: %6.1f min",
+               pass == 0 ? "no watchdog" : "watchdog", fights_per_hour[pass], watchdog->incidents, watchdog->recovered,
+               watchdog->recovered > 0 ? watchdog->downtime_ms / 1000.0 / watchdog->recovered : 0.0,
+               watchdog->downtime_ms / 60000.0 * 24.0 * 3600000.0 / stats.elapsed_ms);
+        if (pass == 1) {
+            int world = config_find_state(&watched, "world");
+            unsigned learned = watchdog_limit(watchdog, world);
+            printf("\n    stall limit on the world view: %.1f s", learned / 1000.0);
+            checks++;
+            failures += learned >= settings->stall_ms;
+            checks++;
+            failures += watchdog->incidents != faults || watchdog->recovered != faults || stats.restarts != faults / 3;
+            for (int k = 0; k < 3; k++) {
+                int expected = (faults + 2 - k) / 3;
+                printf("\n    %-12s %d fixed by %s", names[k], watchdog->recovered_by[fixes[k]], recovery_name(fixes[k]));
+                checks++;
+                failures += watchdog->recovered_by[fixes[k]] != expected;
+            }
+        }
+        test_stop(&scheduler, backend);
+    }
+    checks++;
+    failures += fights_per_hour[1] <= fights_per_hour[0];
+
+    // Esc must reach the stuck client, not the one that clicked last
+    SimulatorConfig two_clients;
+    simulator_default_config(&two_clients);
+    two_clients.clients = 2;
+    Backend *backend = test_start(&scheduler, &two_clients, &watched, &watched.modes[0]);
+    if (backend == NULL) {
+        return failures + 1;
+    }
+    scheduler_set_restart(&scheduler, restart_simulated, backend);
+    uint64_t start = backend->now_ms(backend);
+    // The first client is the left one of the two tiles, whichever instance got its window
+    Instance *stuck = &scheduler.instances[0], *other = &scheduler.instances[1];
+    if (stuck->window.x > other->window.x) {
+        stuck = &scheduler.instances[1];
+        other = &scheduler.instances[0];
+    }
+    uintptr_t first_id = stuck->window.id;
+    int menus = 3;
+    for (int i = 0; i <= menus; i++) {
+        scheduler_run(&scheduler, start + (i + 1) * fault_every);
+        simulator_inject(backend, 0, i < menus ? SIM_FAULT_MENU : SIM_FAULT_DISCONNECT);
+    }
+    scheduler_run(&scheduler, start + (menus + 2) * fault_every);
+    SimulatorStats stats = simulator_stats(backend);
+    const Watchdog *first = &stuck->watchdog;
+    printf("\n  2 clients, menus in the first: %d, closed by escape: %d, restarted: %d, fights/hour: %.1f", menus,
+           first->recovered_by[RECOVERY_ESCAPE], first->recovered_by[RECOVERY_RESTART], test_fights_per_hour(&stats));
+    checks++;
+    failures += first->incidents != menus + 1 || first->recovered_by[RECOVERY_ESCAPE] != menus ||
+                first->recovered_by[RECOVERY_RESTART] != 1 || other->watchdog.incidents != 0;
+    // Still on the left, in the window that replaced its old one
+    checks++;
+    failures += stuck->window.x >= other->window.x || stuck->window.id == first_id || stuck->window.id == other->window.id;
+    test_stop(&scheduler, backend);
+
+    // No false alarms: every mode farms without a stall
+    int stalls = 0;
+    for (int i = 0; i < watched.mode_count; i++) {
+        SimulatorConfig sim_config;
+        simulator_default_config(&sim_config);
+        Backend *backend = test_start(&scheduler, &sim_config, &watched, &watched.modes[i]);
+        if (backend == NULL) {
+            return failures + 1;
+        }
+        test_run(&scheduler, hours);
+        stalls += scheduler.instances[0].watchdog.incidents;
+        test_stop(&scheduler, backend);
+    }
+    checks++;
+    failures += stalls != 0;
+    printf("\n  stalls without faults in %d modes: %d", watched.mode_count, stalls);
+    printf("\n  %d/%d checks passed", checks - failures, checks);
+    return failures;
+}
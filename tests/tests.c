@@ -0,0 +1,157 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tests.h"
+#include "wait.h"
+
+GameConfig test_config = {0};
+Anchor test_anchor = {0};
+
+
+Backend *test_start(Scheduler *scheduler, const SimulatorConfig *sim_config, const GameConfig *config, const GameMode *mode) {
+    Backend *backend = simulator_create(sim_config);
+    if (backend == NULL) {
+        printf("\nError: Failed to create the simulator.\n");
+        return NULL;
+    }
+    if (!scheduler_init(scheduler, backend, config, mode, &test_anchor, TEST_SETTLE_MS, NULL)) {
+        backend_destroy(backend);
+        return NULL;
+    }
+    return backend;
+}
+
+
+void test_run(Scheduler *scheduler, double hours) {
+    Backend *backend = scheduler->backend;
+    scheduler_run(scheduler, backend->now_ms(backend) + (uint64_t)(hours * 3600000.0));
+}
+
+
+void test_stop(Scheduler *scheduler, Backend *backend) {
+    scheduler_free(scheduler);
+    backend_destroy(backend);
+}
+
+
+double test_fights_per_hour(const SimulatorStats *stats) {
+    return stats->elapsed_ms > 0 ? stats->fights / (stats->elapsed_ms / 3600000.0) : 0.0;
+}
+
+
+static bool fake_capture(Backend *self, int x, int y, int width, int height, Frame *frame) {
+    FakeScreen *fake = self->ctx;
+    if (fake->paint == NULL || !frame_reserve(frame, width, height)) {
+        return false;
+    }
+    frame->x = x;
+    frame->y = y;
+    fake->paint(fake->paint_ctx, fake->now, frame);
+    frame->sequence++;
+    frame->time_ms = fake->now;
+    fake->captures++;
+    return true;
+}
+
+
+static void fake_send(Backend *self, const InputEvent *events, int count) {
+    FakeScreen *fake = self->ctx;
+    fake->sends++;
+    for (int i = 0; i < count; i++) {
+        if (fake->count < TEST_FAKE_EVENTS) {
+            fake->events[fake->count] = events[i];
+            fake->delivered_ms[fake->count++] = fake->now;
+        }
+        fake->now += events[i].hold_ms;
+    }
+}
+
+
+static ScreenMetrics fake_metrics(Backend *self) {
+    FakeScreen *fake = self->ctx;
+    return fake->screen;
+}
+
+
+static uint64_t fake_now_ms(Backend *self) {
+    FakeScreen *fake = self->ctx;
+    return fake->now;
+}
+
+
+static void fake_sleep_ms(Backend *self, unsigned ms) {
+    FakeScreen *fake = self->ctx;
+    fake->now += ms;
+}
+
+
+static void fake_destroy(Backend *self) {
+    free(self->ctx);
+    free(self);
+}
+
+
+Backend *test_fake_create(ScreenMetrics screen, FakePaint paint, void *paint_ctx) {
+    Backend *backend = calloc(1, sizeof(Backend));
+    FakeScreen *fake = calloc(1, sizeof(FakeScreen));
+    if (backend == NULL || fake == NULL) {
+        free(backend);
+        free(fake);
+        return NULL;
+    }
+    fake->screen = screen;
+    fake->paint = paint;
+    fake->paint_ctx = paint_ctx;
+    fake->now = 1000;
+    backend->name = "fake screen";
+    backend->ctx = fake;
+    backend->capture = fake_capture;
+    backend->send = fake_send;
+    backend->metrics = fake_metrics;
+    backend->windows = backend_whole_screen;
+    backend->focus = backend_focus_screen;
+    backend->now_ms = fake_now_ms;
+    backend->sleep_ms = fake_sleep_ms;
+    backend->destroy = fake_destroy;
+    return backend;
+}
+
+
+/**
+ * @brief Runs every test against the simulated client
+ * Usage: tests [--config <path>] [hours]
+ * @return 0 if every check passed, 1 otherwise
+ */
+int main(int argc, char *argv[]) {
+    const char *config_path = "simulator.cfg";
+    if (argc > 2 && strcmp(argv[1], "--config") == 0) {
+        config_path = argv[2];
+        argc -= 2;
+        argv += 2;
+    }
+    // Simulated hours of every farm run
+    double hours = argc > 1 ? atof(argv[1]) : 0.5;
+    if (!config_load(&test_config, config_path) || !simulator_anchor(&test_anchor)) {
+        return 1;
+    }
+    wait_verbose = false;
+
+    int failures = 0;
+    failures += test_match();
+    failures += test_locator();
+    failures += test_input();
+    failures += test_wait();
+    failures += test_capture_thread(0, 1000);
+    failures += test_capture_thread(16, 500);
+    failures += test_recording(0.1);
+    failures += test_telemetry();
+    failures += test_rotation(hours);
+    failures += test_battle(hours);
+    failures += test_watchdog(hours);
+    failures += test_training(hours);
+    failures += test_shipped_config("miscrits.cfg", hours);
+
+    printf("\n%s: %d failed checks\n", failures == 0 ? "PASSED" : "FAILED", failures);
+    anchor_free(&test_anchor);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,82 @@
+#ifndef TESTS_H
+#define TESTS_H
+
+#include <stdbool.h>
+#include "backend.h"
+#include "config.h"
+#include "locator.h"
+#include "scheduler.h"
+#include "simulator.h"
+
+// How long the screen must stay still after a click before a dialog counts as opened/closed,
+// as in a farm run (ms)
+#define TEST_SETTLE_MS 250
+
+// Data file of the simulated client and its emblem, loaded by the runner before any test
+extern GameConfig test_config;
+extern Anchor test_anchor;
+
+/**
+ * @brief Creates the simulated client(s) and sets up a scheduler on them, without telemetry
+ * @return The simulator, NULL if it or the scheduler could not be set up
+ */
+Backend *test_start(Scheduler *scheduler, const SimulatorConfig *sim_config, const GameConfig *config, const GameMode *mode);
+
+/**
+ * @brief Farms for a number of simulated hours from the current time of the simulator
+ */
+void test_run(Scheduler *scheduler, double hours);
+
+void test_stop(Scheduler *scheduler, Backend *backend);
+
+#define TEST_FAKE_EVENTS 64
+
+/**
+ * @brief Paints what a fake screen shows at a time of its clock into a frame of its size
+ */
+typedef void (*FakePaint)(void *ctx, uint64_t now, Frame *frame);
+
+/**
+ * @brief The context of a fake backend: a screen on a virtual clock that keeps every input
+ * event it was sent and the time each was delivered at. The holds and sleeps advance the
+ * clock, captures take no time.
+ */
+typedef struct {
+    ScreenMetrics screen;
+    FakePaint paint;      // NULL: captures fail
+    void *paint_ctx;
+    uint64_t now;
+    InputEvent events[TEST_FAKE_EVENTS];
+    uint64_t delivered_ms[TEST_FAKE_EVENTS];
+    int count;            // Events kept, the first TEST_FAKE_EVENTS
+    int sends;            // Backend calls with input
+    int captures;
+} FakeScreen;
+
+/**
+ * @brief Creates a fake backend, its clock at 1000 ms. The FakeScreen is its ctx.
+ * @return NULL if it could not be allocated
+ */
+Backend *test_fake_create(ScreenMetrics screen, FakePaint paint, void *paint_ctx);
+
+/**
+ * @brief Fights per hour of simulated time
+ */
+double test_fights_per_hour(const SimulatorStats *stats);
+
+// Every test prints one summary and returns its number of failed checks
+
+int test_match(void);
+int test_locator(void);
+int test_input(void);
+int test_wait(void);
+int test_capture_thread(unsigned interval_ms, unsigned duration_ms);
+int test_recording(double hours);
+int test_telemetry(void);
+int test_rotation(double hours);
+int test_battle(double hours);
+int test_watchdog(double hours);
+int test_training(double hours);
+int test_shipped_config(const char *path, double hours);
+
+#endif